@@ -0,0 +1,201 @@
+// Measures the throughput of the bounded queues against the unbounded LFQueue they replaced, and
+// checks that every value arrives exactly once and in the order each producer pushed it.
+//
+// Usage: QueueBenchmark [values per producer] [producers]
+
+#include "Util/BoundedQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Capacity of the bounded queues, matching the audio engine's event queues
+constexpr size_t queueCapacity = 1024;
+
+namespace
+{
+	// The unbounded single-producer single-consumer queue previously used by the engine, kept here as
+	// the baseline. Pushing allocates a node and frees the nodes the consumer has passed.
+	template<typename T>
+	class LFQueue
+	{
+	public:
+
+		LFQueue()
+		{
+			begin = current = end = new Node(T());
+		}
+
+		~LFQueue()
+		{
+			while (begin != nullptr) {
+				Node* tmp = begin;
+				begin = tmp->next;
+				delete tmp;
+			}
+		}
+
+		bool push(const T& val)
+		{
+			Node* node = end.load()->next = new Node(val);
+			end.store(node);
+
+			while (begin != current) {
+				Node* tmp = begin;
+				begin = begin->next;
+				delete tmp;
+			}
+			return true;
+		}
+
+		bool pop(T& val)
+		{
+			if (current != end) {
+				Node* next = current.load()->next;
+				val = next->value;
+				current.store(next);
+				return true;
+			}
+			return false;
+		}
+
+	private:
+
+		struct Node
+		{
+			Node(T val) : value(val), next(nullptr) {}
+			T value;
+			Node* next;
+		};
+
+		Node* begin;
+		std::atomic<Node*> current, end;
+	};
+
+	// LFQueue only supports one producer, so producers take turns through a mutex
+	template<typename T>
+	class LockedLFQueue
+	{
+	public:
+
+		bool push(const T& val)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return queue.push(val);
+		}
+
+		bool pop(T& val)
+		{
+			return queue.pop(val);
+		}
+
+	private:
+
+		LFQueue<T> queue;
+		std::mutex mutex;
+	};
+
+	// A value tagged with its producer and its position in that producer's sequence
+	struct Message
+	{
+		uint32_t producer;
+		uint32_t sequence;
+	};
+
+	// Push `count` values from each of `producers` threads while this thread pops them. Both sides yield
+	// when the queue is full or empty, so that results stay meaningful with fewer cores than threads. Returns the elapsed seconds, or a negative value if any value was lost, duplicated or
+	// reordered within its producer.
+	template<typename Queue>
+	double run(Queue& queue, size_t count, size_t producers)
+	{
+		std::atomic<bool> bStart(false);
+		std::vector<std::thread> threads;
+		for (size_t p = 0; p < producers; p++) {
+			threads.emplace_back([&queue, &bStart, count, p] {
+				while (!bStart.load(std::memory_order_acquire)) std::this_thread::yield();
+				for (size_t i = 0; i < count; i++) {
+					Message message{ static_cast<uint32_t>(p), static_cast<uint32_t>(i) };
+					while (!queue.push(message)) std::this_thread::yield();
+				}
+			});
+		}
+
+		std::vector<uint32_t> expected(producers, 0);
+		bool bValid = true;
+
+		auto begin = std::chrono::steady_clock::now();
+		bStart.store(true, std::memory_order_release);
+		for (size_t received = 0; received < count * producers;) {
+			Message message;
+			if (!queue.pop(message)) {
+				std::this_thread::yield();
+				continue;
+			}
+			if (message.producer >= producers || message.sequence != expected[message.producer]) bValid = false;
+			else expected[message.producer]++;
+			received++;
+		}
+		auto end = std::chrono::steady_clock::now();
+
+		for (auto& thread : threads) thread.join();
+		return bValid ? std::chrono::duration<double>(end - begin).count() : -1.0;
+	}
+
+	// Run and print one benchmark. Returns false if the ordering check failed.
+	template<typename Queue>
+	bool report(const char* label, Queue& queue, size_t count, size_t producers)
+	{
+		double seconds = run(queue, count, producers);
+		if (seconds < 0.0) {
+			printf("%-28s FAILED: values lost or out of order\n", label);
+			return false;
+		}
+
+		double total = static_cast<double>(count * producers);
+		printf("%-28s %10.2f Mops/s %10.1f ns/op\n", label, total / seconds * 1e-6, seconds * 1e9 / total);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	size_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+	size_t producers = argc > 2 ? strtoul(argv[2], nullptr, 10) : 4;
+	if (count == 0 || producers == 0) {
+		printf("Usage: QueueBenchmark [values per producer] [producers]\n");
+		return 1;
+	}
+
+	printf("%zu values per producer, capacity %zu\n\n", count, queueCapacity);
+	bool bPassed = true;
+
+	printf("1 producer\n");
+	{
+		SPSCQueue<Message> queue(queueCapacity);
+		bPassed &= report("SPSCQueue", queue, count, 1);
+	}
+	{
+		MPSCQueue<Message> queue(queueCapacity);
+		bPassed &= report("MPSCQueue", queue, count, 1);
+	}
+	{
+		LFQueue<Message> queue;
+		bPassed &= report("LFQueue", queue, count, 1);
+	}
+
+	printf("\n%zu producers\n", producers);
+	{
+		MPSCQueue<Message> queue(queueCapacity);
+		bPassed &= report("MPSCQueue", queue, count, producers);
+	}
+	{
+		LockedLFQueue<Message> queue;
+		bPassed &= report("LFQueue + mutex", queue, count, producers);
+	}
+
+	return bPassed ? 0 : 1;
+}
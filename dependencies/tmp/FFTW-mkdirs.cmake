@@ -0,0 +1,22 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file Copyright.txt or https://cmake.org/licensing for details.
+
+cmake_minimum_required(VERSION 3.5)
+
+file(MAKE_DIRECTORY
+  "/root/repo/dependencies/src/FFTW"
+  "/root/repo/dependencies/src/FFTW-build"
+  "/root/repo/dependencies"
+  "/root/repo/dependencies/tmp"
+  "/root/repo/dependencies/src/FFTW-stamp"
+  "/root/repo/dependencies/src"
+  "/root/repo/dependencies/src/FFTW-stamp"
+)
+
+set(configSubDirs )
+foreach(subDir IN LISTS configSubDirs)
+    file(MAKE_DIRECTORY "/root/repo/dependencies/src/FFTW-stamp/${subDir}")
+endforeach()
+if(cfgdir)
+  file(MAKE_DIRECTORY "/root/repo/dependencies/src/FFTW-stamp${cfgdir}") # cfgdir has leading slash
+endif()
@@ -2,12 +2,15 @@
 #include "UScene.h"
 #include "Loader.h"
 #include "../Systems/SystemInterface.h"
+#include "../Systems/Audio/AudioSystem.h"
 #include "../Managers/StateManager.h"
 #include "../Managers/EnvironmentManager.h"
 #include <SDL.h>
+#include <chrono>
 
 Engine::Engine() :
-	bInitialized(false)
+	bInitialized(false),
+	bOffline(false)
 {
 }
 
@@ -62,9 +65,25 @@ bool Engine::init()
 	return true;
 }
 
+bool Engine::initOffline(float sampleRate)
+{
+	loader = std::make_unique<Loader>();
+	audioSystem = std::move(loader->createAudioSystem().audio);
+
+	if (!static_cast<AudioSystem*>(audioSystem.get())->initOffline(sampleRate)) {
+		printf("Warning: Audio system failed to initialize for offline rendering!\n");
+		deinit();
+		return false;
+	}
+
+	bOffline = true;
+	return true;
+}
+
 void Engine::deinit()
 {
 	bInitialized = false;
+	bOffline = false;
 	scenes.clear();
 
 	loader.reset();
@@ -117,6 +136,30 @@ void Engine::run()
 	} while (!EnvironmentManager::instance().bQuitRequested);
 }
 
+bool Engine::renderOffline(const std::string& filepath, float seconds, size_t speakers)
+{
+	if (!bOffline) return false;
+
+	auto* uscene = scenes.emplace_back(std::make_unique<UScene>(this)).get();
+	loader->loadRenderScene(uscene, speakers);
+
+	auto* audio = static_cast<AudioSystem*>(audioSystem.get());
+	audio->resetProfile();
+	auto start = std::chrono::steady_clock::now();
+	bool bSuccess = audio->renderOffline(filepath, seconds);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	if (!bSuccess) {
+		printf("Failed to render %s\n", filepath.c_str());
+		return false;
+	}
+
+	AudioProfile profile = audio->profile();
+	printf("Rendered %.2f s of %zu speakers to %s in %.3f s (%.1fx real time)\n", seconds, speakers, filepath.c_str(), elapsed.count(), seconds / elapsed.count());
+	printf("Block time: mean %.1f us, 99th percentile %.1f us, max %.1f us\n", profile.callbackDuration.mean(), profile.callbackDuration.percentile(0.99), profile.callbackDuration.max);
+	return true;
+}
+
 LoaderInterface* Engine::loaderInterface() const
 {
 	return loader.get();
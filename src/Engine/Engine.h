@@ -2,6 +2,7 @@
 
 #include <list>
 #include <memory>
+#include <string>
 
 class Engine
 {
@@ -13,11 +14,18 @@ public:
 
 	bool init();
 
+	// Initialize only the audio system, without a window or audio device, for renderOffline()
+	bool initOffline(float sampleRate);
+
 	void deinit();
 
 	// Main runloop, returns on user exit
 	void run();
 
+	// Render `seconds` of a microphone surrounded by `speakers` speakers to the wav file at `filepath`,
+	// as fast as possible, and print the processing time. Requires initOffline(). Returns success.
+	bool renderOffline(const std::string& filepath, float seconds, size_t speakers);
+
 	// Return a pointer to the Loader's public interface
 	class LoaderInterface* loaderInterface() const;
 
@@ -31,6 +39,9 @@ private:
 	// True only after a successful call to init()
 	bool bInitialized;
 
+	// True only after a successful call to initOffline()
+	bool bOffline;
+
 	std::unique_ptr<class Loader> loader;
 
 	std::unique_ptr<class SystemInterface> inputSystem;
@@ -26,6 +26,9 @@
 #include "../Systems/Audio/Components/AMicrophone.h"
 #include "../Systems/Audio/Components/ASpeaker.h"
 
+#include <cmath>
+#include <cstdio>
+
 Loader::Loader() :
 	inputSystem(nullptr),
 	graphicsSystem(nullptr),
@@ -73,6 +76,21 @@ Loader::SystemsWrapper Loader::createSystems()
 	};
 }
 
+Loader::SystemsWrapper Loader::createAudioSystem()
+{
+	auto audio = std::make_unique<AudioSystem>();
+
+	auto& serviceManager = ServiceManager::instance();
+	audio->assetManager   = &AssetManager::instance();
+	audio->serviceManager = &serviceManager;
+
+	audioSystem = audio.get();
+
+	SystemsWrapper systems;
+	systems.audio = std::move(audio);
+	return systems;
+}
+
 void Loader::loadDefaultScene(UScene* uscene)
 {
 	inputSystem->createSystemScene(uscene);
@@ -95,6 +113,28 @@ void Loader::loadDefaultScene(UScene* uscene)
 	}
 }
 
+void Loader::loadRenderScene(UScene* uscene, size_t speakers)
+{
+	audioSystem->createSystemScene(uscene);
+
+	AssetDescriptor microphone, speaker;
+	if (!AssetManager::instance().descriptor("Microphone", microphone) || !AssetManager::instance().descriptor("Speaker", speaker)) {
+		printf("Render scene assets not found.\n");
+		return;
+	}
+
+	auto* umicrophone = createObjectFromAsset(microphone, uscene);
+	umicrophone->eventImmediate(EventType::PositionUpdated, mat::vec3 { 0, 0, 0 });
+
+	// spread the speakers over rings around the microphone, all within reach of it
+	for (size_t i = 0; i < speakers; i++) {
+		float angle = 2.f * 3.14159265f * static_cast<float>(i) / static_cast<float>(speakers);
+		float radius = 2.f + 1.5f * static_cast<float>(i % 4);
+		auto* uspeaker = createObjectFromAsset(speaker, uscene);
+		uspeaker->eventImmediate(EventType::PositionUpdated, mat::vec3 { radius * std::cos(angle), 0, radius * std::sin(angle) });
+	}
+}
+
 UObject* Loader::createDefaultCamera(UScene* uscene)
 {
 	auto* inputScene = inputSystem->findSystemScene(uscene);
@@ -118,11 +158,10 @@ UObject* Loader::createObjectFromAsset(AssetID asset, UScene* uscene) const
 
 UObject* Loader::createObjectFromAsset(const AssetDescriptor& asset, UScene* uscene) const
 {
-	auto* graphicsScene = graphicsSystem->findSystemScene(uscene);
-	auto* physicsScene = physicsSystem->findSystemScene(uscene);
-
 	UObject* uobject = uscene->createUniversalObject();
-	if (asset.assetType == AssetType::Object && !asset.modelPath.empty()) {
+	if (asset.assetType == AssetType::Object && !asset.modelPath.empty() && graphicsSystem && physicsSystem) {
+		auto* graphicsScene = graphicsSystem->findSystemScene(uscene);
+		auto* physicsScene = physicsSystem->findSystemScene(uscene);
 		auto* gobj = graphicsScene->createSystemObject<MeshGraphicsObject>(uobject);
 		auto* pobj = physicsScene->createSystemObject<PhysicsObject>(uobject);
 		gobj->setMesh(asset.modelPath);
@@ -133,10 +172,11 @@ UObject* Loader::createObjectFromAsset(const AssetDescriptor& asset, UScene* usc
 		auto* aobj = audioScene->createSystemObject<AudioObject>(uobject);
 		switch (asset.audioType) {
 		case AudioType::Microphone:
-			audioScene->setAudioComponentForObject<AMicrophone>(aobj);
+			audioScene->setAudioComponentForObject<AMicrophone>(aobj, asset.ambisonicOrder);
 			break;
 		case AudioType::Speaker:
-			audioScene->setAudioComponentForObject<ASpeaker>(aobj);
+			if (asset.audioSourcePath.empty()) audioScene->setAudioComponentForObject<ASpeaker>(aobj);
+			else audioScene->setAudioComponentForObject<ASpeaker>(aobj, asset.audioSourcePath);
 			break;
 		default:
 			break;
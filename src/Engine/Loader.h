@@ -19,8 +19,15 @@ public:
 
 	SystemsWrapper createSystems();
 
+	// Create only the audio system, for rendering without a window or audio device. The other
+	// systems of the returned wrapper are null.
+	SystemsWrapper createAudioSystem();
+
 	void loadDefaultScene(class UScene* uscene);
 
+	// Load an audio-only scene of a microphone at the origin surrounded by `speakers` speakers
+	void loadRenderScene(class UScene* uscene, size_t speakers);
+
 	class UObject* createObjectFromAsset(AssetID asset, class UScene* uscene) const override;
 	class UObject* createObjectFromAsset(const AssetDescriptor& asset, class UScene* uscene) const override;
 	class UObject* createUIObject(class UScene* uscene) const override;
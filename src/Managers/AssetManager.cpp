@@ -1,4 +1,6 @@
 #include "AssetManager.h"
+#include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iostream>
 #include <filesystem>
@@ -64,6 +66,19 @@ inline bool setAssetModelPath(const std::string& s, std::string& path)
 	return std::filesystem::exists(path);
 }
 
+inline bool setAudioSourcePath(const std::string& s, std::string& path)
+{
+	path = "res/sound/" + s;
+	return std::filesystem::exists(path);
+}
+
+inline bool setAmbisonicOrder(const std::string& s, size_t& order)
+{
+	if (s.empty() || !std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); })) return false;
+	order = std::stoul(s);
+	return true;
+}
+
 bool AssetManager::parseLine(const std::string& line, AssetDescriptor& descriptor)
 {
 	std::smatch match;
@@ -78,6 +93,10 @@ bool AssetManager::parseLine(const std::string& line, AssetDescriptor& descripto
 			return setAudioType(val, descriptor.audioType);
 		if (key == "Model")
 			return setAssetModelPath(val, descriptor.modelPath);
+		if (key == "AudioSource")
+			return setAudioSourcePath(val, descriptor.audioSourcePath);
+		if (key == "AmbisonicOrder")
+			return setAmbisonicOrder(val, descriptor.ambisonicOrder);
 	}
 
 	return false;
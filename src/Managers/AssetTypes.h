@@ -22,6 +22,8 @@ struct AssetDescriptor
 	AssetType assetType;
 	AudioType audioType;
 	std::string modelPath;
+	std::string audioSourcePath;
+	size_t ambisonicOrder;
 	std::string uiImagePath;
 	AssetID assetID;
 };
@@ -1,12 +1,16 @@
 #include "StateManager.h"
 
+// Capacity of the unregistration queue. Overflowing requests are not lost, only slower.
+constexpr size_t removeQueueCapacity = 4096;
+
 StateManager& StateManager::instance()
 {
 	static StateManager instance;
 	return instance;
 }
 
-StateManager::StateManager()
+StateManager::StateManager() :
+	removeQueue(removeQueueCapacity)
 {
 }
 
@@ -40,7 +44,10 @@ StateManager::ObserverID StateManager::registerObserver(
 
 void StateManager::unregisterObserver(ObserverID id)
 {
-	removeQueue.push(id);
+	if (!removeQueue.push(id)) {
+		std::lock_guard<std::mutex> lock(removeOverflowMutex);
+		removeOverflow.push_back(id);
+	}
 }
 
 void StateManager::notifyObservers()
@@ -50,6 +57,13 @@ void StateManager::notifyObservers()
 	while (removeQueue.pop(id)) {
 		observers.remove_if([id](const ObserverData& data) { return data.id == id; });
 	}
+	{
+		std::lock_guard<std::mutex> lock(removeOverflowMutex);
+		for (ObserverID overflowID : removeOverflow) {
+			observers.remove_if([overflowID](const ObserverData& data) { return data.id == overflowID; });
+		}
+		removeOverflow.clear();
+	}
 
 	while (!eventQueue.empty()) {
 		auto& event = eventQueue.front();
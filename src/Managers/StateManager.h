@@ -1,10 +1,12 @@
 #pragma once
 
-#include "../Util/LFQueue.h"
+#include "../Util/BoundedQueue.h"
 #include "../Util/Observer.h"
 #include <utility>
 #include <queue>
 #include <list>
+#include <vector>
+#include <mutex>
 
 class StateManager
 {
@@ -53,8 +55,12 @@ private:
 	};
 	std::queue<Event> eventQueue;
 
-	// Stores pending observers which have requested unregistration
-	LFQueue<ObserverID> removeQueue;
+	// Stores pending observers which have requested unregistration. Observers may be destroyed on any thread.
+	MPSCQueue<ObserverID> removeQueue;
+
+	// Unregistration requests which did not fit into removeQueue
+	std::vector<ObserverID> removeOverflow;
+	std::mutex removeOverflowMutex;
 
 public:
 
@@ -0,0 +1,173 @@
+#include "AMappedFile.h"
+#include <cstdio>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	size_t pageSize()
+	{
+#if defined(_WIN32)
+		static const size_t size = [] {
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return static_cast<size_t>(info.dwPageSize);
+		}();
+#else
+		static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+		return size;
+	}
+}
+
+AMappedFile::AMappedFile() :
+	mappedData(nullptr),
+	mappedSize(0),
+#if defined(_WIN32)
+	fileHandle(INVALID_HANDLE_VALUE),
+	mappingHandle(nullptr)
+#else
+	fileDescriptor(-1)
+#endif
+{
+}
+
+AMappedFile::~AMappedFile()
+{
+	close();
+}
+
+bool AMappedFile::open(const std::string& filepath)
+{
+	close();
+
+#if defined(_WIN32)
+	fileHandle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		printf("Unable to open file: %s\n", filepath.c_str());
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		printf("Unable to map empty file: %s\n", filepath.c_str());
+		close();
+		return false;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	void* view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view) {
+		printf("Unable to map file: %s\n", filepath.c_str());
+		close();
+		return false;
+	}
+
+	mappedData = static_cast<const uint8_t*>(view);
+	mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+	fileDescriptor = ::open(filepath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0) {
+		printf("Unable to open file: %s\n", filepath.c_str());
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fileDescriptor, &info) != 0 || info.st_size == 0) {
+		printf("Unable to map empty file: %s\n", filepath.c_str());
+		close();
+		return false;
+	}
+
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+	if (view == MAP_FAILED) {
+		printf("Unable to map file: %s\n", filepath.c_str());
+		close();
+		return false;
+	}
+
+	mappedData = static_cast<const uint8_t*>(view);
+	mappedSize = static_cast<size_t>(info.st_size);
+	madvise(view, mappedSize, MADV_SEQUENTIAL);
+#endif
+
+	return true;
+}
+
+void AMappedFile::close()
+{
+#if defined(_WIN32)
+	if (mappedData) UnmapViewOfFile(mappedData);
+	if (mappingHandle) CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+	if (mappedData) munmap(const_cast<uint8_t*>(mappedData), mappedSize);
+	if (fileDescriptor >= 0) ::close(fileDescriptor);
+	fileDescriptor = -1;
+#endif
+
+	mappedData = nullptr;
+	mappedSize = 0;
+}
+
+bool AMappedFile::isOpen() const
+{
+	return mappedData != nullptr;
+}
+
+const uint8_t* AMappedFile::data() const
+{
+	return mappedData;
+}
+
+size_t AMappedFile::size() const
+{
+	return mappedSize;
+}
+
+void AMappedFile::prefetch(size_t offset, size_t length) const
+{
+	if (offset >= mappedSize || length == 0) return;
+	if (length > mappedSize - offset) length = mappedSize - offset;
+
+	// widen to whole pages
+	size_t begin = offset - offset % pageSize();
+	size_t end = offset + length;
+
+#if defined(_WIN32)
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<uint8_t*>(mappedData + begin);
+	range.NumberOfBytes = end - begin;
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+	madvise(const_cast<uint8_t*>(mappedData + begin), end - begin, MADV_WILLNEED);
+#endif
+}
+
+void AMappedFile::release(size_t offset, size_t length) const
+{
+	if (offset >= mappedSize) return;
+	if (length > mappedSize - offset) length = mappedSize - offset;
+
+	// shrink to whole pages, so pages shared with data still in use are kept
+	size_t page = pageSize();
+	size_t begin = (offset + page - 1) / page * page;
+	size_t end = (offset + length) / page * page;
+	if (end <= begin) return;
+
+#if defined(_WIN32)
+	// unlocking pages that aren't locked removes them from the working set
+	VirtualUnlock(const_cast<uint8_t*>(mappedData + begin), end - begin);
+#else
+	madvise(const_cast<uint8_t*>(mappedData + begin), end - begin, MADV_DONTNEED);
+#endif
+}
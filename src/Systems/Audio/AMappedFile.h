@@ -0,0 +1,50 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on first access, so only the
+// parts of the file that are touched take up memory, and consumed ranges can be released again.
+class AMappedFile
+{
+public:
+
+	AMappedFile();
+
+	~AMappedFile();
+
+	AMappedFile(const AMappedFile&) = delete;
+	AMappedFile& operator=(const AMappedFile&) = delete;
+
+	// Map the file at `filepath`, closing any previous mapping. Returns success.
+	bool open(const std::string& filepath);
+
+	// Unmap the file
+	void close();
+
+	bool isOpen() const;
+
+	const uint8_t* data() const;
+
+	size_t size() const;
+
+	// Hint that `length` bytes at `offset` will be read soon, so the OS can start loading them
+	void prefetch(size_t offset, size_t length) const;
+
+	// Hint that `length` bytes at `offset` won't be read again for a while, so the OS can drop them
+	// from this process' resident memory. The contents remain readable.
+	void release(size_t offset, size_t length) const;
+
+private:
+
+	const uint8_t* mappedData;
+
+	size_t mappedSize;
+
+#if defined(_WIN32)
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileDescriptor;
+#endif
+};
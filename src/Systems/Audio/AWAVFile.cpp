@@ -1,54 +1,198 @@
 #include "AWAVFile.h"
+#include "AMappedFile.h"
 #include <fstream>
+#include <algorithm>
+#include <cstring>
 
-AWAVFile::AWAVFile(std::string filepath) :
+namespace
+{
+	template<typename T>
+	T readLE(const uint8_t* src)
+	{
+		T value;
+		memcpy(&value, src, sizeof(T));
+		return value;
+	}
+
+	AWAVEncoding encodingFor(uint16_t formatTag, uint16_t bitDepth)
+	{
+		if (formatTag == 1) { // PCM
+			switch (bitDepth) {
+			case 8: return AWAVEncoding::UInt8;
+			case 16: return AWAVEncoding::Int16;
+			case 24: return AWAVEncoding::Int24;
+			case 32: return AWAVEncoding::Int32;
+			}
+		}
+		else if (formatTag == 3) { // IEEE float
+			switch (bitDepth) {
+			case 32: return AWAVEncoding::Float32;
+			case 64: return AWAVEncoding::Float64;
+			}
+		}
+		return AWAVEncoding::Unsupported;
+	}
+}
+
+AWAVFormat::AWAVFormat() :
+	encoding(AWAVEncoding::Unsupported),
 	channels(0),
-	sampleRate(0)
+	sampleRate(0),
+	frameSize(0),
+	dataOffset(0),
+	frameCount(0)
 {
-	std::ifstream fs(filepath, std::ios_base::in | std::ios_base::binary);
-	if (!fs) {
-		printf("Unable to open file: %s\n", filepath.c_str());
-		return;
+}
+
+bool AWAVFormat::parse(const uint8_t* file, size_t size)
+{
+	*this = AWAVFormat();
+	if (size < 12) return false;
+
+	bool bRF64 = !memcmp(file, "RF64", 4);
+	if ((memcmp(file, "RIFF", 4) && !bRF64) || memcmp(file + 8, "WAVE", 4)) return false;
+
+	bool bFormat = false;
+	bool bData = false;
+	uint64_t rf64DataSize = 0;
+	size_t dataSize = 0;
+
+	size_t pos = 12;
+	while (pos + 8 <= size) {
+		const uint8_t* chunk = file + pos;
+		uint64_t chunkSize = readLE<uint32_t>(chunk + 4);
+		size_t available = size - pos - 8;
+
+		if (!memcmp(chunk, "ds64", 4) && chunkSize >= 24 && available >= 24) {
+			// 64-bit sizes of an RF64 file
+			rf64DataSize = readLE<uint64_t>(chunk + 16);
+		}
+		else if (!memcmp(chunk, "fmt ", 4) && chunkSize >= 16 && available >= 16) {
+			uint16_t formatTag = readLE<uint16_t>(chunk + 8);
+			channels = readLE<uint16_t>(chunk + 10);
+			sampleRate = readLE<uint32_t>(chunk + 12);
+			frameSize = readLE<uint16_t>(chunk + 20);
+			uint16_t bitDepth = readLE<uint16_t>(chunk + 22);
+
+			// WAVE_FORMAT_EXTENSIBLE stores the actual format tag at the start of the subformat GUID
+			if (formatTag == 0xfffe && chunkSize >= 40 && available >= 40) formatTag = readLE<uint16_t>(chunk + 32);
+
+			encoding = encodingFor(formatTag, bitDepth);
+			bFormat = encoding != AWAVEncoding::Unsupported && channels > 0 && frameSize == channels * (bitDepth / 8);
+		}
+		else if (!memcmp(chunk, "data", 4)) {
+			if (bRF64 && chunkSize == 0xffffffff) chunkSize = rf64DataSize;
+
+			// files that were never finalized may claim more data than they hold
+			dataOffset = pos + 8;
+			dataSize = static_cast<size_t>(std::min<uint64_t>(chunkSize, available));
+			bData = true;
+		}
+
+		// chunks are padded to an even size
+		if (chunkSize > available) break;
+		pos += 8 + static_cast<size_t>(chunkSize) + static_cast<size_t>(chunkSize & 1);
 	}
 
-	char header[44];
-	fs.read(header, sizeof(header));
-	if (!fs) {
-		printf("Invalid wav file: %s\n", filepath.c_str());
-		return;
+	if (!bFormat || !bData) {
+		*this = AWAVFormat();
+		return false;
 	}
 
-	if (strncmp(header + 0, "RIFF", 4) ||
-		strncmp(header + 8, "WAVE", 4) ||
-		strncmp(header + 12, "fmt ", 4) ||
-		strncmp(header + 36, "data", 4) ||
-		*(uint32_t*)(header + 16) != 16 || // PCM chunk size
-		*(uint16_t*)(header + 20) != 1 ||  // PCM format
-		*(uint16_t*)(header + 34) != 16)   // bit depth
-	{
-		printf("Invalid wav header: %s\n", filepath.c_str());
+	frameCount = dataSize / frameSize;
+	return true;
+}
+
+void AWAVFormat::convert(const uint8_t* src, float* dst, size_t frames) const
+{
+	size_t n = frames * channels;
+	switch (encoding) {
+	case AWAVEncoding::UInt8:
+		for (size_t i = 0; i < n; i++) dst[i] = (static_cast<float>(src[i]) - 128.f) * (1.f / 128.f);
+		break;
+	case AWAVEncoding::Int16:
+		for (size_t i = 0; i < n; i++) dst[i] = static_cast<float>(readLE<int16_t>(src + i * 2)) * (1.f / 32768.f);
+		break;
+	case AWAVEncoding::Int24:
+		for (size_t i = 0; i < n; i++) {
+			const uint8_t* s = src + i * 3;
+			int32_t value = static_cast<int32_t>((uint32_t(s[0]) << 8) | (uint32_t(s[1]) << 16) | (uint32_t(s[2]) << 24)) >> 8;
+			dst[i] = static_cast<float>(value) * (1.f / 8388608.f);
+		}
+		break;
+	case AWAVEncoding::Int32:
+		for (size_t i = 0; i < n; i++) dst[i] = static_cast<float>(readLE<int32_t>(src + i * 4)) * (1.f / 2147483648.f);
+		break;
+	case AWAVEncoding::Float32:
+		memcpy(dst, src, n * sizeof(float));
+		break;
+	case AWAVEncoding::Float64:
+		for (size_t i = 0; i < n; i++) dst[i] = static_cast<float>(readLE<double>(src + i * 8));
+		break;
+	default:
+		std::fill_n(dst, n, 0.f);
+	}
+}
+
+AWAVFile::AWAVFile() :
+	channels(0),
+	sampleRate(0)
+{
+}
+
+AWAVFile::AWAVFile(std::string filepath) :
+	channels(0),
+	sampleRate(0)
+{
+	AMappedFile file;
+	if (!file.open(filepath)) return;
+
+	AWAVFormat format;
+	if (!format.parse(file.data(), file.size())) {
+		printf("Invalid or unsupported wav file: %s\n", filepath.c_str());
 		return;
 	}
 
-	channels = *(uint16_t*)(header + 22);
-	sampleRate = *(uint32_t*)(header + 24);
+	channels = format.channels;
+	sampleRate = format.sampleRate;
+	data.resize(format.frameCount * format.channels);
+	format.convert(file.data() + format.dataOffset, data.data(), format.frameCount);
+}
 
-	uint32_t byteCount = *(uint32_t*)(header + 40);
-	uint32_t sampleCount = byteCount / 2;
-	data.reserve(sampleCount);
+bool AWAVFile::save(std::string filepath) const
+{
+	if (!channels || !sampleRate) return false;
 
-	int16_t* buffer = new int16_t[sampleCount];
-	fs.read((char*)buffer, byteCount);
+	std::ofstream fs(filepath, std::ios_base::out | std::ios_base::binary);
 	if (!fs) {
-		printf("Error reading wav data: %s\n", filepath.c_str());
-		data.resize(0);
-		return;
+		printf("Unable to open file: %s\n", filepath.c_str());
+		return false;
 	}
 
-	for (std::streamsize i = 0; i < sampleCount; i++) {
-		float raw = static_cast<float>(buffer[i]);
-		data.push_back(raw / INT16_MAX);
+	uint32_t byteCount = static_cast<uint32_t>(data.size() * sizeof(float));
+	uint16_t blockAlign = static_cast<uint16_t>(channels * sizeof(float));
+
+	char header[44];
+	memcpy(header + 0, "RIFF", 4);
+	*(uint32_t*)(header + 4) = 36 + byteCount;
+	memcpy(header + 8, "WAVE", 4);
+	memcpy(header + 12, "fmt ", 4);
+	*(uint32_t*)(header + 16) = 16;                      // PCM chunk size
+	*(uint16_t*)(header + 20) = 3;                       // IEEE float format
+	*(uint16_t*)(header + 22) = channels;
+	*(uint32_t*)(header + 24) = sampleRate;
+	*(uint32_t*)(header + 28) = sampleRate * blockAlign; // byte rate
+	*(uint16_t*)(header + 32) = blockAlign;
+	*(uint16_t*)(header + 34) = 32;                      // bit depth
+	memcpy(header + 36, "data", 4);
+	*(uint32_t*)(header + 40) = byteCount;
+
+	fs.write(header, sizeof(header));
+	fs.write((const char*)data.data(), byteCount);
+	if (!fs) {
+		printf("Error writing wav data: %s\n", filepath.c_str());
+		return false;
 	}
 
-	delete[] buffer;
+	return true;
 }
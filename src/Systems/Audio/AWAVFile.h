@@ -2,10 +2,54 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+
+// Sample encoding of a wav file's data chunk
+enum class AWAVEncoding
+{
+	Unsupported,
+	UInt8,
+	Int16,
+	Int24,
+	Int32,
+	Float32,
+	Float64
+};
+
+// Format and location of the sample data of a wav file in memory
+struct AWAVFormat
+{
+	AWAVFormat();
+
+	// Walk the RIFF (or RF64) chunks of the wav file in `file`, in any order, skipping chunks
+	// other than "fmt " and "data". Returns success.
+	bool parse(const uint8_t* file, size_t size);
+
+	// Convert `frames` interleaved frames at `src`, which must point into the data chunk, to floats
+	void convert(const uint8_t* src, float* dst, size_t frames) const;
+
+	AWAVEncoding encoding;
+	uint16_t channels;
+	uint32_t sampleRate;
+
+	// Bytes per interleaved frame
+	size_t frameSize;
+
+	// Byte offset of the first frame in the file
+	size_t dataOffset;
+
+	// Number of complete frames in the file
+	size_t frameCount;
+};
 
 struct AWAVFile
 {
+	AWAVFile();
 	AWAVFile(std::string filepath);
+
+	// Write `data` to disk as an interleaved 32-bit float wav file. Returns success.
+	bool save(std::string filepath) const;
+
 	uint16_t channels;
 	uint32_t sampleRate;
 	std::vector<float> data;
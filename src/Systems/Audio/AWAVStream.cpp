@@ -0,0 +1,273 @@
+#include "AWAVStream.h"
+#include <algorithm>
+#include <cstdio>
+
+// Duration of audio buffered ahead of the audio thread (seconds)
+constexpr float ringSeconds = 0.5f;
+
+// The prefetch thread is woken once the ring holds less than this fraction of its size
+constexpr float refillThreshold = 0.5f;
+
+// Frames converted from the file per pass
+constexpr size_t sourceChunk = 1024;
+
+// Bytes of the file requested from the OS ahead of the conversion position
+constexpr size_t readAheadBytes = 4 << 20;
+
+namespace
+{
+	// Catmull-Rom interpolation between y1 and y2
+	float hermite(const float* y, float t)
+	{
+		float c1 = 0.5f * (y[2] - y[0]);
+		float c2 = y[0] - 2.5f * y[1] + 2.f * y[2] - 0.5f * y[3];
+		float c3 = 0.5f * (y[3] - y[0]) + 1.5f * (y[1] - y[2]);
+		return ((c3 * t + c2) * t + c1) * t + y[1];
+	}
+
+	size_t nextPowerOfTwo(size_t n)
+	{
+		size_t p = 1;
+		while (p < n) p <<= 1;
+		return p;
+	}
+}
+
+AWAVStream::AWAVStream() :
+	bLoop(true),
+	channel(-1),
+	ringMask(0),
+	ringWritePos(0),
+	ringReadPos(0),
+	bFinished(true),
+	underruns(0),
+	wakeRequests(0),
+	bWakePending(false),
+	bStop(false),
+	bSynchronous(false),
+	step(1.0),
+	windowPos(0),
+	phase(0.0),
+	sourceFrame(0),
+	releasedBytes(0),
+	prefetchedBytes(0),
+	bSourceEnded(false)
+{
+}
+
+AWAVStream::~AWAVStream()
+{
+	stop();
+}
+
+bool AWAVStream::open(const std::string& filepath, int channel)
+{
+	stop();
+	if (!file.open(filepath)) return false;
+
+	if (!wavFormat.parse(file.data(), file.size())) {
+		printf("Invalid or unsupported wav file: %s\n", filepath.c_str());
+		file.close();
+		return false;
+	}
+
+	if (channel >= static_cast<int>(wavFormat.channels)) {
+		printf("Channel %d out of range in wav file: %s\n", channel, filepath.c_str());
+		file.close();
+		return false;
+	}
+
+	this->channel = channel;
+	return true;
+}
+
+void AWAVStream::start(float sampleRate, bool bSynchronous)
+{
+	stop();
+	if (!file.isOpen()) return;
+
+	ring.assign(nextPowerOfTwo(static_cast<size_t>(sampleRate * ringSeconds)), 0.f);
+	ringMask = ring.size() - 1;
+	ringWritePos.store(0);
+	ringReadPos.store(0);
+	underruns.store(0);
+
+	step = static_cast<double>(wavFormat.sampleRate) / static_cast<double>(sampleRate);
+	convertBuffer.resize(sourceChunk * wavFormat.channels);
+
+	// one frame of silence before the first, so the first output is the first frame
+	window.assign(1, 0.f);
+	window.reserve(sourceChunk + 4);
+	windowPos = 0;
+	phase = 0.0;
+	sourceFrame = 0;
+	releasedBytes = 0;
+	prefetchedBytes = 0;
+	bSourceEnded = false;
+
+	fill();
+
+	this->bSynchronous = bSynchronous;
+	bFinished.store(bSourceEnded);
+	if (bSynchronous) return;
+
+	bStop.store(false);
+	bWakePending.store(false);
+	prefetchThread = std::thread([this] { prefetchLoop(); });
+}
+
+void AWAVStream::stop()
+{
+	if (prefetchThread.joinable()) {
+		bStop.store(true);
+		wakeRequests.fetch_add(1);
+		wakeRequests.notify_one();
+		prefetchThread.join();
+	}
+	bFinished.store(true);
+}
+
+size_t AWAVStream::read(float* out, size_t n)
+{
+	if (bSynchronous) {
+		fill();
+		if (bSourceEnded) bFinished.store(true, std::memory_order_relaxed);
+	}
+
+	uint64_t readPos = ringReadPos.load(std::memory_order_relaxed);
+	size_t available = static_cast<size_t>(ringWritePos.load(std::memory_order_acquire) - readPos);
+	size_t count = std::min(n, available);
+
+	size_t begin = static_cast<size_t>(readPos) & ringMask;
+	size_t first = std::min(count, ring.size() - begin);
+	std::copy_n(ring.data() + begin, first, out);
+	std::copy_n(ring.data(), count - first, out + first);
+	ringReadPos.store(readPos + count, std::memory_order_release);
+
+	if (bFinished.load(std::memory_order_relaxed)) return count;
+	if (count < n) underruns.fetch_add(1, std::memory_order_relaxed);
+
+	// wake the prefetch thread to top up the ring. Notifying never blocks, and only enters the
+	// kernel if the thread is actually sleeping.
+	if (!bSynchronous && available - count < static_cast<size_t>(ring.size() * refillThreshold) && !bWakePending.exchange(true)) {
+		wakeRequests.fetch_add(1, std::memory_order_release);
+		wakeRequests.notify_one();
+	}
+	return count;
+}
+
+size_t AWAVStream::underrunCount() const
+{
+	return underruns.load(std::memory_order_relaxed);
+}
+
+const AWAVFormat& AWAVStream::format() const
+{
+	return wavFormat;
+}
+
+void AWAVStream::prefetchLoop()
+{
+	uint32_t requests = wakeRequests.load(std::memory_order_acquire);
+	while (!bStop.load()) {
+		// requests from here on are either served by this fill or wake the next wait
+		bWakePending.store(false);
+		fill();
+
+		// once the last samples are in the ring, reads stop requesting and only stop() wakes us
+		if (bSourceEnded) bFinished.store(true);
+
+		wakeRequests.wait(requests, std::memory_order_acquire);
+		requests = wakeRequests.load(std::memory_order_acquire);
+	}
+}
+
+size_t AWAVStream::fill()
+{
+	uint64_t writePos = ringWritePos.load(std::memory_order_relaxed);
+	size_t space = ring.size() - static_cast<size_t>(writePos - ringReadPos.load(std::memory_order_acquire));
+
+	size_t produced = 0;
+	while (produced < space) {
+		// interpolation needs the two frames on either side of the output position
+		if (windowPos + 3 >= window.size()) {
+			if (bSourceEnded) break;
+
+			size_t consumed = std::min(windowPos, window.size());
+			window.erase(window.begin(), window.begin() + consumed);
+			windowPos -= consumed;
+
+			size_t size = window.size();
+			window.resize(size + sourceChunk);
+			size_t count = readSource(window.data() + size, sourceChunk);
+			window.resize(size + count);
+
+			// flush the last frames through the interpolator
+			if (count == 0) {
+				window.resize(size + 2, 0.f);
+				bSourceEnded = true;
+			}
+			continue;
+		}
+
+		float t = static_cast<float>(phase);
+		ring[static_cast<size_t>(writePos + produced) & ringMask] = hermite(window.data() + windowPos, t);
+		produced++;
+
+		phase += step;
+		size_t advance = static_cast<size_t>(phase);
+		windowPos += advance;
+		phase -= static_cast<double>(advance);
+	}
+
+	ringWritePos.store(writePos + produced, std::memory_order_release);
+	return produced;
+}
+
+size_t AWAVStream::readSource(float* dst, size_t frames)
+{
+	size_t count = 0;
+	while (count < frames) {
+		if (sourceFrame == wavFormat.frameCount) {
+			if (!bLoop || wavFormat.frameCount == 0) break;
+			sourceFrame = 0;
+			releasedBytes = 0;
+			prefetchedBytes = 0;
+		}
+
+		size_t n = std::min({ frames - count, wavFormat.frameCount - sourceFrame, sourceChunk });
+		size_t offset = sourceFrame * wavFormat.frameSize;
+		size_t bytes = n * wavFormat.frameSize;
+
+		// keep the OS loading ahead of us, so converting rarely waits for the disk
+		if (offset + readAheadBytes / 2 >= prefetchedBytes) {
+			file.prefetch(wavFormat.dataOffset + prefetchedBytes, offset + readAheadBytes - prefetchedBytes);
+			prefetchedBytes = offset + readAheadBytes;
+		}
+
+		wavFormat.convert(file.data() + wavFormat.dataOffset + offset, convertBuffer.data(), n);
+
+		size_t channels = wavFormat.channels;
+		if (channel >= 0) {
+			for (size_t i = 0; i < n; i++) dst[count + i] = convertBuffer[i * channels + channel];
+		}
+		else {
+			float scale = 1.f / static_cast<float>(channels);
+			for (size_t i = 0; i < n; i++) {
+				float sum = 0.f;
+				for (size_t c = 0; c < channels; c++) sum += convertBuffer[i * channels + c];
+				dst[count + i] = sum * scale;
+			}
+		}
+
+		// drop converted pages from memory, so resident size stays constant however long the file
+		if (offset + bytes >= releasedBytes + readAheadBytes) {
+			file.release(wavFormat.dataOffset + releasedBytes, offset + bytes - releasedBytes);
+			releasedBytes = offset + bytes;
+		}
+
+		sourceFrame += n;
+		count += n;
+	}
+	return count;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "AMappedFile.h"
+#include "AWAVFile.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// AWAVStream plays a wav file of any length in constant memory. The file is memory mapped, and a
+// background thread converts, mixes down and resamples upcoming frames into a lock-free ring that
+// the audio thread reads from, so the audio thread never touches the file or waits on I/O. The audio
+// thread wakes the background thread whenever the ring drops below half full.
+class AWAVStream
+{
+public:
+
+	AWAVStream();
+
+	~AWAVStream();
+
+	// Map the wav file at `filepath` and parse its format. `channel` selects a single channel of
+	// the file, or all channels are mixed down if -1. Returns success.
+	bool open(const std::string& filepath, int channel = -1);
+
+	// Begin streaming from the start of the file, resampled to `sampleRate`. The ring is filled
+	// before returning, so the first reads don't underrun. If `bSynchronous`, no prefetch thread is
+	// started and read() converts frames on the calling thread instead, so offline renders never underrun.
+	void start(float sampleRate, bool bSynchronous = false);
+
+	// Stop streaming and join the prefetch thread
+	void stop();
+
+	// Called from the audio thread. Read up to `n` samples into `out`. Never blocks unless synchronous,
+	// and returns fewer than `n` samples if the prefetch thread falls behind or the file has ended.
+	size_t read(float* out, size_t n);
+
+	// Number of reads that came up short while streaming
+	size_t underrunCount() const;
+
+	const AWAVFormat& format() const;
+
+	// Restart from the beginning at the end of the file. Set before start().
+	bool bLoop;
+
+private:
+
+	// Main loop of the prefetch thread
+	void prefetchLoop();
+
+	// Resample source frames into the free space of the ring. Returns the number of samples produced.
+	size_t fill();
+
+	// Convert up to `frames` frames at the file position to mono, wrapping if looping. Returns the
+	// number of frames converted, which is only less than `frames` at the end of the file.
+	size_t readSource(float* dst, size_t frames);
+
+	AMappedFile file;
+
+	AWAVFormat wavFormat;
+
+	// Selected channel, or -1 to mix down
+	int channel;
+
+	// Samples ready for the audio thread. Size is a power of two.
+	std::vector<float> ring;
+	size_t ringMask;
+
+	// Absolute positions in `ring`. Written only by the prefetch thread and the audio thread respectively.
+	alignas(64) std::atomic<uint64_t> ringWritePos;
+	alignas(64) std::atomic<uint64_t> ringReadPos;
+
+	// True while no further samples will be produced
+	std::atomic<bool> bFinished;
+
+	std::atomic<size_t> underruns;
+
+	std::thread prefetchThread;
+
+	// Incremented to wake the prefetch thread, by the audio thread when the ring runs low and by stop()
+	std::atomic<uint32_t> wakeRequests;
+
+	// True from a wake request until the prefetch thread begins filling, so each refill is requested once
+	std::atomic<bool> bWakePending;
+
+	std::atomic<bool> bStop;
+
+	// Frames are converted by read() rather than the prefetch thread
+	bool bSynchronous;
+
+	// Source frames per output sample
+	double step;
+
+	// Mono source frames being interpolated. The output position lies between
+	// window[windowPos + 1] and window[windowPos + 2], at `phase`.
+	std::vector<float> window;
+	size_t windowPos;
+	double phase;
+
+	// Interleaved frames converted from the file
+	std::vector<float> convertBuffer;
+
+	// Next frame to convert
+	size_t sourceFrame;
+
+	// Data bytes below this offset have been released, and up to this offset prefetched
+	size_t releasedBytes;
+	size_t prefetchedBytes;
+
+	// End of file reached and the interpolation window flushed
+	bool bSourceEnded;
+};
@@ -1,6 +1,11 @@
 #include "AudioEngine.h"
 #include "AudioScene.h"
+#include "AudioProfiler.h"
+#include "AudioWorkerPool.h"
+#include "DSP/ABus.h"
+#include "DSP/AConvolver.h"
 #include "DSP/ADelayLine.h"
+#include "DSP/AFFTPlanner.h"
 #include "Components/AudioComponent.h"
 #include "Components/GeneratingAudioComponent.h"
 #include "Components/AuralizingAudioComponent.h"
@@ -8,6 +13,12 @@
 #include <portaudio.h>
 #include <algorithm>
 
+// FFTW wisdom is loaded from and saved to this file, so FFT plans are only measured once per machine
+constexpr const char* fftWisdomFilepath = "fftw_wisdom.dat";
+
+// Capacity of each engine event queue. Overflowing events are not lost, only delayed.
+constexpr size_t eventQueueCapacity = 1024;
+
 int pa_callback(
 	const void* input,
 	void* output,
@@ -16,6 +27,13 @@ int pa_callback(
 	PaStreamCallbackFlags statusFlags,
 	void* userData)
 {
+	AudioProfiler::instance().recordStreamStatus(
+		statusFlags & paOutputUnderflow,
+		statusFlags & paOutputOverflow,
+		statusFlags & paInputUnderflow,
+		statusFlags & paInputOverflow,
+		timeInfo ? timeInfo->outputBufferDacTime - timeInfo->currentTime : 0.0);
+
 	((AudioEngine*)userData)->process_float((float*)output, static_cast<size_t>(frameCount));
 	return paContinue;
 }
@@ -23,7 +41,12 @@ int pa_callback(
 AudioEngine::AudioEngine() :
 	audioStream(nullptr),
 	sampleRate(48000.f),
-	channels(2)
+	channels(2),
+	externalEventQueue(eventQueueCapacity),
+	internalEventQueue(eventQueueCapacity),
+	eventQueueOverflows(0),
+	workerPool(std::make_unique<AudioWorkerPool>(AudioWorkerPool::defaultWorkerCount())),
+	outputBus(std::make_unique<ABus>())
 {
 }
 
@@ -57,8 +80,29 @@ bool AudioEngine::init()
 	}
 
 	sampleRate = static_cast<float>(defaultDeviceInfo->defaultSampleRate);
+	outputBus->init(ABusLayout::forChannelCount(channels), std::min(ABus::maxBlockFrames, ADelayLine::capacity(sampleRate)));
+
+	AFFTPlanner::instance().loadWisdom(fftWisdomFilepath);
+	for (const auto& c : audioComponents) {
+		c->bOffline = false;
+		c->init(sampleRate);
+	}
+	return true;
+}
 
-	for (const auto& c : audioComponents) c->init(sampleRate);
+bool AudioEngine::initOffline(float sampleRate, int channels)
+{
+	if (audioStream || sampleRate <= 0.f || channels <= 0 || channels > static_cast<int>(ABusLayout::maxChannels)) return false;
+
+	this->sampleRate = sampleRate;
+	this->channels = channels;
+	outputBus->init(ABusLayout::forChannelCount(channels), std::min(ABus::maxBlockFrames, ADelayLine::capacity(sampleRate)));
+
+	AFFTPlanner::instance().loadWisdom(fftWisdomFilepath);
+	for (const auto& c : audioComponents) {
+		c->bOffline = true;
+		c->init(sampleRate);
+	}
 	return true;
 }
 
@@ -70,6 +114,11 @@ void AudioEngine::deinit()
 		audioStream = nullptr;
 	}
 	for (const auto& c : audioComponents) c->deinit();
+
+	// no component holds a plan anymore, and no IR is being prepared with one
+	AConvolver::waitForPendingIRs();
+	AFFTPlanner::instance().saveWisdom(fftWisdomFilepath);
+	AFFTPlanner::instance().clear();
 }
 
 bool AudioEngine::start()
@@ -96,21 +145,34 @@ void AudioEngine::stop()
 
 void AudioEngine::process_float(float* buffer, size_t frames)
 {
-	// zero output buffer
-	std::fill_n(buffer, frames * channels, 0.f);
+	auto& profiler = AudioProfiler::instance();
+	profiler.beginCallback();
 
-	// process audio for all scenes
-	for (const auto& scene : scenes) scene->processSceneAudio(buffer, frames);
+	// process audio for all scenes into the planar bus, then interleave it into the device buffer
+	if (outputBus->maxFrames() == 0) std::fill_n(buffer, frames * channels, 0.f);
+	for (size_t offset = 0; offset < frames && outputBus->maxFrames() > 0; offset += outputBus->maxFrames()) {
+		size_t blockFrames = std::min(outputBus->maxFrames(), frames - offset);
+		outputBus->clear(blockFrames);
+		for (const auto& scene : scenes) scene->processSceneAudio(*outputBus, blockFrames, *workerPool);
+		outputBus->interleave(buffer + offset * channels, blockFrames);
+	}
 
-	// handle pending changes to audio objects from outside the audio thread
+	// handle pending changes to audio objects from outside the audio thread. Removal events need
+	// room in internalEventQueue, so events stay queued until the next callback while it is full.
 	ExternalAudioEngineEvent event;
-	while (externalEventQueue.pop(event)) {
+	while (true) {
+		if (internalEventQueue.full()) {
+			eventQueueOverflows.fetch_add(1, std::memory_order_relaxed);
+			break;
+		}
+		if (!externalEventQueue.pop(event)) break;
+
 		switch (event.type) {
 		case ExternalAudioEngineEvent::Type::SceneAdded:
 			activeScenes.push_back(event.scene);
 			break;
 		case ExternalAudioEngineEvent::Type::SceneRemoved:
-			internalEventQueue.push(InternalAudioEngineEvent{ InternalAudioEngineEvent::Type::DeleteScene, nullptr, event.scene });
+			(void)internalEventQueue.push(InternalAudioEngineEvent{ InternalAudioEngineEvent::Type::DeleteScene, nullptr, event.scene });
 			activeScenes.erase(std::remove(activeScenes.begin(), activeScenes.end(), event.scene), activeScenes.end());
 			break;
 		case ExternalAudioEngineEvent::Type::ComponentAdded:
@@ -118,13 +180,36 @@ void AudioEngine::process_float(float* buffer, size_t frames)
 			break;
 		case ExternalAudioEngineEvent::Type::ComponentRemoved:
 			event.scene->disconnectAudioComponent(event.component);
-			internalEventQueue.push(InternalAudioEngineEvent{ InternalAudioEngineEvent::Type::DeleteComponent, event.component, event.scene });
+			(void)internalEventQueue.push(InternalAudioEngineEvent{ InternalAudioEngineEvent::Type::DeleteComponent, event.component, event.scene });
+			break;
+		case ExternalAudioEngineEvent::Type::ConnectionsChanged:
+			if (event.scene->applyConnectionChanges()) {
+				(void)internalEventQueue.push(InternalAudioEngineEvent{ InternalAudioEngineEvent::Type::ReleaseConnections, nullptr, event.scene });
+			}
 		}
 	}
+
+	profiler.endCallback(frames, sampleRate);
+}
+
+void AudioEngine::render(float* buffer, size_t frames, size_t blockSize)
+{
+	blockSize = std::min(blockSize, maxBlockSize());
+	if (audioStream || !blockSize) return;
+
+	for (size_t offset = 0; offset < frames; offset += blockSize) {
+		process_float(buffer + offset * channels, std::min(blockSize, frames - offset));
+	}
 }
 
 void AudioEngine::tick(float deltaTime)
 {
+	// resubmit events that did not fit into the queue earlier
+	{
+		std::lock_guard<std::mutex> lock(externalEventMutex);
+		flushExternalEventBacklog();
+	}
+
 	// handle pending changes pushed from the audio thread
 	InternalAudioEngineEvent event;
 	while (internalEventQueue.pop(event)) {
@@ -145,6 +230,9 @@ void AudioEngine::tick(float deltaTime)
 				}
 			}
 		}
+		else if (event.type == InternalAudioEngineEvent::Type::ReleaseConnections) {
+			event.scene->releaseRemovedConnections();
+		}
 	}
 }
 
@@ -155,7 +243,7 @@ void AudioEngine::registerScene(std::shared_ptr<AudioScene> scene)
 	ExternalAudioEngineEvent event;
 	event.type = ExternalAudioEngineEvent::Type::SceneAdded;
 	event.scene = scene.get();
-	externalEventQueue.push(event);
+	pushExternalEvent(event);
 }
 
 void AudioEngine::unregisterScene(AudioScene* scene)
@@ -163,18 +251,19 @@ void AudioEngine::unregisterScene(AudioScene* scene)
 	ExternalAudioEngineEvent event;
 	event.type = ExternalAudioEngineEvent::Type::SceneRemoved;
 	event.scene = scene;
-	externalEventQueue.push(event);
+	pushExternalEvent(event);
 }
 
 void AudioEngine::registerComponent(std::unique_ptr<AudioComponent> component, AudioScene* scene)
 {
+	component->bOffline = !audioStream;
 	component->init(sampleRate);
 
 	ExternalAudioEngineEvent event;
 	event.type = ExternalAudioEngineEvent::Type::ComponentAdded;
 	event.component = audioComponents.emplace_back(std::move(component)).get();
 	event.scene = scene;
-	externalEventQueue.push(event);
+	pushExternalEvent(event);
 }
 
 void AudioEngine::unregisterComponent(AudioComponent* component, AudioScene* scene)
@@ -183,5 +272,56 @@ void AudioEngine::unregisterComponent(AudioComponent* component, AudioScene* sce
 	event.type = ExternalAudioEngineEvent::Type::ComponentRemoved;
 	event.component = component;
 	event.scene = scene;
-	externalEventQueue.push(event);
+	pushExternalEvent(event);
+}
+
+void AudioEngine::changeConnections(AudioScene* scene)
+{
+	ExternalAudioEngineEvent event;
+	event.type = ExternalAudioEngineEvent::Type::ConnectionsChanged;
+	event.component = nullptr;
+	event.scene = scene;
+	pushExternalEvent(event);
+}
+
+float AudioEngine::currentSampleRate() const
+{
+	return sampleRate;
+}
+
+size_t AudioEngine::maxBlockSize() const
+{
+	return outputBus->maxFrames();
+}
+
+int AudioEngine::channelCount() const
+{
+	return channels;
+}
+
+size_t AudioEngine::eventQueueOverflowCount() const
+{
+	return eventQueueOverflows.load(std::memory_order_relaxed);
+}
+
+void AudioEngine::pushExternalEvent(const ExternalAudioEngineEvent& event)
+{
+	std::lock_guard<std::mutex> lock(externalEventMutex);
+
+	// events must reach the audio thread in order, so nothing may overtake the backlog
+	if (flushExternalEventBacklog() && externalEventQueue.push(event)) return;
+
+	if (externalEventBacklog.empty()) {
+		fprintf(stderr, "Audio engine event queue full, delaying events.\n");
+	}
+	externalEventBacklog.push_back(event);
+	eventQueueOverflows.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool AudioEngine::flushExternalEventBacklog()
+{
+	size_t flushed = 0;
+	while (flushed < externalEventBacklog.size() && externalEventQueue.push(externalEventBacklog[flushed])) flushed++;
+	externalEventBacklog.erase(externalEventBacklog.begin(), externalEventBacklog.begin() + flushed);
+	return externalEventBacklog.empty();
 }
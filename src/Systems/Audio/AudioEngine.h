@@ -1,8 +1,9 @@
 #pragma once
 
-#include "../../Util/LFQueue.h"
+#include "../../Util/BoundedQueue.h"
 #include <vector>
 #include <memory>
+#include <mutex>
 
 class AudioEngine
 {
@@ -15,6 +16,10 @@ public:
 	// Set up AudioEngine and open the audio device. Returns success.
 	bool init();
 
+	// Set up AudioEngine without opening an audio device. Audio is then only
+	// processed by calls to render(), as fast as the CPU allows. Returns success.
+	bool initOffline(float sampleRate, int channels);
+
 	// Close the audio device and deinitialize AudioEngine
 	void deinit();
 
@@ -27,6 +32,11 @@ public:
 	// Internal callback called by the unscoped SDL callback
 	void process_float(float* buffer, size_t frames);
 
+	// Render `frames` frames into the interleaved buffer `buffer` in blocks of at most `blockSize`
+	// frames, which is clamped to maxBlockSize(). Only valid after initOffline(), and runs on the
+	// calling thread in place of the device.
+	void render(float* buffer, size_t frames, size_t blockSize);
+
 	// This function is called at a regular interval outside of the audio thread
 	void tick(float deltaTime);
 
@@ -42,6 +52,22 @@ public:
 	// Signal that a component is ready for removal from the audio graph and deletion
 	void unregisterComponent(class AudioComponent* component, class AudioScene* scene);
 
+	// Signal that the latest schedule of `scene` adds or removes connections between its components
+	void changeConnections(class AudioScene* scene);
+
+	// Returns the sample rate of the current session
+	float currentSampleRate() const;
+
+	// Returns the largest number of frames processed at once. Longer device buffers and render blocks
+	// are split, since no block may exceed the output bus or the capacity of a delay line.
+	size_t maxBlockSize() const;
+
+	// Returns the number of interleaved output channels
+	int channelCount() const;
+
+	// Returns the number of times an event could not be queued immediately because a queue was full
+	size_t eventQueueOverflowCount() const;
+
 private:
 
 	// Pointer to the active stream (may be null)
@@ -59,25 +85,42 @@ private:
 			SceneAdded,
 			SceneRemoved,
 			ComponentAdded,
-			ComponentRemoved
+			ComponentRemoved,
+			ConnectionsChanged
 		} type;
 		class AudioComponent* component;
 		class AudioScene* scene;
 	};
 	// This queue takes events from outside the audio thread and is parsed on the audio thread
-	LFQueue<ExternalAudioEngineEvent> externalEventQueue;
+	SPSCQueue<ExternalAudioEngineEvent> externalEventQueue;
+
+	// Events that did not fit into externalEventQueue, resubmitted in order on the next push or tick
+	std::vector<ExternalAudioEngineEvent> externalEventBacklog;
+
+	// Serializes producers of externalEventQueue and guards externalEventBacklog
+	std::mutex externalEventMutex;
+
+	// Push to externalEventQueue, or to the backlog if the queue is full
+	void pushExternalEvent(const ExternalAudioEngineEvent& event);
+
+	// Move as much of the backlog as possible to externalEventQueue. Requires externalEventMutex.
+	bool flushExternalEventBacklog();
 
 	struct InternalAudioEngineEvent
 	{
 		enum class Type {
 			DeleteScene,
-			DeleteComponent
+			DeleteComponent,
+			ReleaseConnections
 		} type;
 		class AudioComponent* component;
 		class AudioScene* scene;
 	};
 	// This queue takes events from the audio thread and is parsed outside the audio thread
-	LFQueue<InternalAudioEngineEvent> internalEventQueue;
+	SPSCQueue<InternalAudioEngineEvent> internalEventQueue;
+
+	// Number of full queue occurrences in either direction
+	std::atomic<size_t> eventQueueOverflows;
 
 	// Contains all existing AudioComponents across all scenes, and is responsible for their deallocation
 	std::vector<std::unique_ptr<class AudioComponent>> audioComponents;
@@ -87,4 +130,10 @@ private:
 
 	// All scenes registered for active processing
 	std::vector<class AudioScene*> activeScenes;
+
+	// Real-time worker threads sharing the processing of each callback
+	std::unique_ptr<class AudioWorkerPool> workerPool;
+
+	// Planar bus all scenes mix into, interleaved into the device buffer at the end of each callback
+	std::unique_ptr<class ABus> outputBus;
 };
@@ -1,4 +1,5 @@
 #include "AudioObject.h"
+#include "AudioScene.h"
 #include "../../Engine/UObject.h"
 #include "Components/AudioComponent.h"
 
@@ -14,7 +15,7 @@ AudioObject::AudioObject(const SystemSceneInterface* scene, const UObject* uobje
 			this->uobject->childEventImmediate(EventType::PositionUpdated, position + parentPosition);
 			if (audioComponent) {
 				audioComponent->position = position + parentPosition;
-				audioComponent->transformUpdated();
+				audioComponent->transformUpdated(static_cast<const AudioScene*>(this->scene)->connectionsOf(audioComponent));
 			}
 		}
 	);
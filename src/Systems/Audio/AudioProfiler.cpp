@@ -0,0 +1,224 @@
+#include "AudioProfiler.h"
+#include <algorithm>
+#include <cmath>
+
+// Histograms of callback load start at 1/256 of the buffer duration
+constexpr double minCallbackLoad = 1.0 / 256.0;
+
+// Histograms of durations start at one microsecond
+constexpr double minDurationMicroseconds = 1.0;
+
+namespace
+{
+	double elapsedMicroseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+AudioHistogram::AudioHistogram(double minValue) :
+	minValue(minValue),
+	count(0),
+	sum(0.0),
+	max(0.0)
+{
+	for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+void AudioHistogram::record(double value)
+{
+	size_t bucket = 0;
+	if (value > minValue) {
+		double position = std::log2(value / minValue) * bucketsPerOctave;
+		bucket = std::min(static_cast<size_t>(position), bucketCount - 1);
+	}
+	buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+	count.fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(value, std::memory_order_relaxed);
+
+	double currentMax = max.load(std::memory_order_relaxed);
+	while (value > currentMax && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed));
+}
+
+void AudioHistogram::reset()
+{
+	for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+	count.store(0, std::memory_order_relaxed);
+	sum.store(0.0, std::memory_order_relaxed);
+	max.store(0.0, std::memory_order_relaxed);
+}
+
+AudioHistogram::Snapshot AudioHistogram::snapshot() const
+{
+	Snapshot snapshot;
+	snapshot.minValue = minValue;
+	snapshot.count = count.load(std::memory_order_relaxed);
+	snapshot.sum = sum.load(std::memory_order_relaxed);
+	snapshot.max = max.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < bucketCount; i++) snapshot.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+	return snapshot;
+}
+
+double AudioHistogram::Snapshot::bucketLowerBound(size_t i) const
+{
+	if (i == 0) return 0.0;
+	return minValue * std::exp2(static_cast<double>(i) / bucketsPerOctave);
+}
+
+double AudioHistogram::Snapshot::mean() const
+{
+	return count ? sum / static_cast<double>(count) : 0.0;
+}
+
+double AudioHistogram::Snapshot::percentile(double p) const
+{
+	uint64_t total = 0;
+	for (uint64_t bucket : buckets) total += bucket;
+	if (total == 0) return 0.0;
+
+	auto target = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(total)));
+	uint64_t accumulated = 0;
+	for (size_t i = 0; i < bucketCount - 1; i++) {
+		accumulated += buckets[i];
+		if (accumulated >= target) return std::min(bucketLowerBound(i + 1), max);
+	}
+	return max;
+}
+
+AudioTimer::AudioTimer(std::string label, const void* owner) :
+	label(label),
+	owner(owner),
+	processTime(minDurationMicroseconds)
+{
+}
+
+AudioTimerScope::AudioTimerScope(AudioTimer* timer) :
+	timer(timer && AudioProfiler::instance().detailedTiming() ? timer : nullptr)
+{
+	if (this->timer) start = std::chrono::steady_clock::now();
+}
+
+AudioTimerScope::~AudioTimerScope()
+{
+	if (timer) timer->processTime.record(elapsedMicroseconds(start));
+}
+
+AudioProfiler::AudioProfiler() :
+	callbacks(0),
+	deadlineMisses(0),
+	backgroundDeadlineMisses(0),
+	outputUnderflows(0),
+	outputOverflows(0),
+	inputUnderflows(0),
+	inputOverflows(0),
+	callbackLoad(minCallbackLoad),
+	callbackDuration(minDurationMicroseconds),
+	outputLatency(minDurationMicroseconds),
+	bDetailedTiming(false)
+{
+}
+
+AudioProfiler& AudioProfiler::instance()
+{
+	static AudioProfiler instance;
+	return instance;
+}
+
+void AudioProfiler::beginCallback()
+{
+	callbackStart = std::chrono::steady_clock::now();
+}
+
+void AudioProfiler::endCallback(size_t frames, float sampleRate)
+{
+	double duration = elapsedMicroseconds(callbackStart);
+	double bufferDuration = static_cast<double>(frames) * 1e6 / static_cast<double>(sampleRate);
+	double load = bufferDuration > 0.0 ? duration / bufferDuration : 0.0;
+
+	callbacks.fetch_add(1, std::memory_order_relaxed);
+	if (load > 1.0) deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+	callbackLoad.record(load);
+	callbackDuration.record(duration);
+}
+
+void AudioProfiler::recordStreamStatus(bool bOutputUnderflow, bool bOutputOverflow, bool bInputUnderflow, bool bInputOverflow, double outputLatency)
+{
+	if (bOutputUnderflow) outputUnderflows.fetch_add(1, std::memory_order_relaxed);
+	if (bOutputOverflow) outputOverflows.fetch_add(1, std::memory_order_relaxed);
+	if (bInputUnderflow) inputUnderflows.fetch_add(1, std::memory_order_relaxed);
+	if (bInputOverflow) inputOverflows.fetch_add(1, std::memory_order_relaxed);
+
+	// some host APIs do not report stream times
+	if (outputLatency > 0.0) this->outputLatency.record(outputLatency * 1e6);
+}
+
+void AudioProfiler::recordBackgroundDeadlineMiss()
+{
+	backgroundDeadlineMisses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AudioProfiler::setDetailedTiming(bool bEnabled)
+{
+	bDetailedTiming.store(bEnabled, std::memory_order_relaxed);
+}
+
+bool AudioProfiler::detailedTiming() const
+{
+	return bDetailedTiming.load(std::memory_order_relaxed);
+}
+
+std::shared_ptr<AudioTimer> AudioProfiler::createTimer(std::string label, const void* owner)
+{
+	auto timer = std::make_shared<AudioTimer>(label, owner);
+
+	std::lock_guard<std::mutex> lock(timersMutex);
+	timers.push_back(timer);
+	return timer;
+}
+
+AudioProfile AudioProfiler::snapshot()
+{
+	AudioProfile profile;
+	profile.callbacks = callbacks.load(std::memory_order_relaxed);
+	profile.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+	profile.backgroundDeadlineMisses = backgroundDeadlineMisses.load(std::memory_order_relaxed);
+	profile.outputUnderflows = outputUnderflows.load(std::memory_order_relaxed);
+	profile.outputOverflows = outputOverflows.load(std::memory_order_relaxed);
+	profile.inputUnderflows = inputUnderflows.load(std::memory_order_relaxed);
+	profile.inputOverflows = inputOverflows.load(std::memory_order_relaxed);
+	profile.callbackLoad = callbackLoad.snapshot();
+	profile.callbackDuration = callbackDuration.snapshot();
+	profile.outputLatency = outputLatency.snapshot();
+
+	std::lock_guard<std::mutex> lock(timersMutex);
+	timers.erase(std::remove_if(timers.begin(), timers.end(), [](const std::weak_ptr<AudioTimer>& timer) {
+		return timer.expired();
+	}), timers.end());
+
+	for (const auto& weakTimer : timers) {
+		if (auto timer = weakTimer.lock()) {
+			auto processTime = timer->processTime.snapshot();
+			if (processTime.count > 0) profile.timers.push_back({ timer->label, timer->owner, processTime });
+		}
+	}
+	return profile;
+}
+
+void AudioProfiler::reset()
+{
+	callbacks.store(0, std::memory_order_relaxed);
+	deadlineMisses.store(0, std::memory_order_relaxed);
+	backgroundDeadlineMisses.store(0, std::memory_order_relaxed);
+	outputUnderflows.store(0, std::memory_order_relaxed);
+	outputOverflows.store(0, std::memory_order_relaxed);
+	inputUnderflows.store(0, std::memory_order_relaxed);
+	inputOverflows.store(0, std::memory_order_relaxed);
+	callbackLoad.reset();
+	callbackDuration.reset();
+	outputLatency.reset();
+
+	std::lock_guard<std::mutex> lock(timersMutex);
+	for (const auto& weakTimer : timers) {
+		if (auto timer = weakTimer.lock()) timer->processTime.reset();
+	}
+}
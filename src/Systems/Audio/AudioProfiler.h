@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// AudioHistogram counts values into logarithmically spaced buckets using relaxed atomics, so that
+// the audio thread and workers can record without locks while another thread takes snapshots.
+class AudioHistogram
+{
+public:
+
+	static constexpr size_t bucketsPerOctave = 4;
+	static constexpr size_t bucketCount = 64;
+
+	// Values up to `minValue` fall into the first bucket, values beyond the range into the last
+	AudioHistogram(double minValue);
+
+	void record(double value);
+
+	void reset();
+
+	struct Snapshot
+	{
+		double minValue;
+		uint64_t count;
+		double sum;
+		double max;
+		std::array<uint64_t, bucketCount> buckets;
+
+		// Smallest value covered by bucket `i`
+		double bucketLowerBound(size_t i) const;
+
+		// Average of all recorded values
+		double mean() const;
+
+		// Upper bound of the bucket containing the `p`th percentile, with p in [0, 1]
+		double percentile(double p) const;
+	};
+
+	Snapshot snapshot() const;
+
+private:
+
+	const double minValue;
+
+	std::array<std::atomic<uint64_t>, bucketCount> buckets;
+
+	std::atomic<uint64_t> count;
+
+	std::atomic<double> sum;
+
+	std::atomic<double> max;
+};
+
+// Processing time of one component or DSP object, in microseconds
+struct AudioTimer
+{
+	AudioTimer(std::string label, const void* owner);
+
+	// Type of the measured object
+	const std::string label;
+
+	// Measured object, for matching profiles to objects
+	const void* const owner;
+
+	AudioHistogram processTime;
+};
+
+// Records the processing time of the enclosing scope into `timer`, if detailed timing is enabled
+class AudioTimerScope
+{
+public:
+
+	AudioTimerScope(AudioTimer* timer);
+
+	~AudioTimerScope();
+
+private:
+
+	AudioTimer* const timer;
+
+	std::chrono::steady_clock::time_point start;
+};
+
+// Snapshot of all audio profiling data
+struct AudioProfile
+{
+	// Number of audio callbacks
+	uint64_t callbacks;
+
+	// Callbacks taking longer than the duration of the audio they produced
+	uint64_t deadlineMisses;
+
+	// Background tasks that had not completed by the time the audio thread needed their result
+	uint64_t backgroundDeadlineMisses;
+
+	// Stream status flags reported by the audio device
+	uint64_t outputUnderflows;
+	uint64_t outputOverflows;
+	uint64_t inputUnderflows;
+	uint64_t inputOverflows;
+
+	// Callback processing time divided by the duration of the processed buffer
+	AudioHistogram::Snapshot callbackLoad;
+
+	// Callback processing time in microseconds
+	AudioHistogram::Snapshot callbackDuration;
+
+	// Time from the start of a callback until its output reaches the DAC, in microseconds
+	AudioHistogram::Snapshot outputLatency;
+
+	struct Timer
+	{
+		std::string label;
+		const void* owner;
+		AudioHistogram::Snapshot processTime;
+	};
+
+	// Per-component and per-convolver processing times, if detailed timing is enabled
+	std::vector<Timer> timers;
+};
+
+// AudioProfiler collects timing of the audio callback and, optionally, of individual components and
+// convolvers. Recording is lock-free and may happen on the audio thread and audio workers.
+class AudioProfiler
+{
+public:
+
+	// Called on the audio thread at the start of each callback
+	void beginCallback();
+
+	// Called on the audio thread at the end of each callback processing `frames` frames
+	void endCallback(size_t frames, float sampleRate);
+
+	// Called on the audio thread with the stream state reported by the audio device
+	void recordStreamStatus(bool bOutputUnderflow, bool bOutputOverflow, bool bInputUnderflow, bool bInputOverflow, double outputLatency);
+
+	// Called on the audio thread when it has to run a background task itself, as it was not done in time
+	void recordBackgroundDeadlineMiss();
+
+	// Enable or disable per-component and per-convolver timing, which is off by default
+	void setDetailedTiming(bool bEnabled);
+
+	bool detailedTiming() const;
+
+	// Create a timer for a component or DSP object. Called outside the audio thread, and the timer
+	// is included in snapshots for as long as the returned pointer is held.
+	std::shared_ptr<AudioTimer> createTimer(std::string label, const void* owner);
+
+	// Copy all profiling data
+	AudioProfile snapshot();
+
+	// Clear all profiling data
+	void reset();
+
+private:
+
+	AudioProfiler();
+
+	std::chrono::steady_clock::time_point callbackStart;
+
+	std::atomic<uint64_t> callbacks;
+	std::atomic<uint64_t> deadlineMisses;
+	std::atomic<uint64_t> backgroundDeadlineMisses;
+	std::atomic<uint64_t> outputUnderflows;
+	std::atomic<uint64_t> outputOverflows;
+	std::atomic<uint64_t> inputUnderflows;
+	std::atomic<uint64_t> inputOverflows;
+
+	AudioHistogram callbackLoad;
+	AudioHistogram callbackDuration;
+	AudioHistogram outputLatency;
+
+	std::atomic<bool> bDetailedTiming;
+
+	// Timers handed out by createTimer(). Expired timers are removed on the next snapshot.
+	std::vector<std::weak_ptr<AudioTimer>> timers;
+
+	// Guards `timers`, which is never accessed on the audio thread
+	std::mutex timersMutex;
+
+public:
+
+	static AudioProfiler& instance();
+
+	// Deleted functions prevent singleton duplication
+	AudioProfiler(AudioProfiler const&) = delete;
+	void operator=(AudioProfiler const&) = delete;
+};
@@ -1,30 +1,83 @@
 #include "AudioScene.h"
 #include "AudioObject.h"
 #include "AudioEngine.h"
+#include "AudioWorkerPool.h"
+#include "AudioProfiler.h"
+#include "AudioSpatialGrid.h"
 #include "Components/AudioComponent.h"
 #include "Components/AuralizingAudioComponent.h"
 #include "Components/OutputAudioComponent.h"
-#include "DSP/ADelayLine.h"
-#include <queue>
+#include "DSP/ADelayLinePool.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <set>
+
+// Default maximum number of connections processed per block
+constexpr size_t defaultVoiceBudget = 64;
+
+// Default audibility below which connections are virtualized, -80 dB
+constexpr float defaultAudibilityThreshold = 1e-4f;
+
+// Audibility bonus of connections that are already real, so that connections near the budget or
+// threshold do not switch state every block
+constexpr float voiceHysteresis = 1.5f;
+
+// Length of the crossfade when a connection is virtualized or restored, in samples
+constexpr size_t voiceFadeSamples = 512;
+
+// Components are connected within this fraction of the maximum delay line distance, and disconnected
+// beyond the full distance, so that components moving near the boundary do not reconnect every tick
+constexpr float connectionHysteresis = 0.9f;
+
+// Relative speeds of source and destination (meters per second) from which new connections resample with
+// 8 and 16 tap windowed sinc, since cubic interpolation aliases audibly at larger Doppler shifts
+constexpr float sinc8Speed = 2.f;
+constexpr float sinc16Speed = 10.f;
 
 AudioScene::AudioScene(const SystemInterface* system, AudioEngine* audioEngine, const UScene* uscene) :
 	SystemSceneInterface(system, uscene),
-	audioEngine(audioEngine)
+	audioEngine(audioEngine),
+	grid(std::make_unique<AudioSpatialGrid>(ADelayLine::maximumDistance)),
+	graphVersion(0),
+	connectedVersion(0),
+	latestSchedule(nullptr),
+	processedVersion(0),
+	scheduleRebuilds(0),
+	voiceBudget(defaultVoiceBudget),
+	audibilityThreshold(defaultAudibilityThreshold),
+	virtualVoices(0)
 {
+	// start out with the schedule of the empty graph
+	rebuildSchedule();
 }
 
 AudioScene::~AudioScene()
 {
 	audioObjects.clear();
-	for (auto* component : components) audioEngine->unregisterComponent(component, this);
+	for (auto* component : graphComponents) audioEngine->unregisterComponent(component, this);
 }
 
 void AudioScene::deleteSystemObject(const UObject* uobject)
 {
 	for (const auto& audioObject : audioObjects) {
 		if (audioObject->uobject == uobject) {
-			if (audioObject->audioComponent) {
-				audioEngine->unregisterComponent(audioObject->audioComponent, this);
+			if (auto* component = audioObject->audioComponent) {
+				graphComponents.erase(std::remove(graphComponents.begin(), graphComponents.end(), component), graphComponents.end());
+				grid->remove(component);
+
+				// the delay lines stay listed by the component until it is deleted, which frees them
+				auto connections = graphConnections.find(component);
+				if (connections != graphConnections.end()) {
+					std::vector<uint32_t> indices = std::move(connections->second);
+					for (uint32_t index : indices) removeConnection(index);
+					graphConnections.erase(component);
+				}
+				listCapacities.erase(component);
+				graphVersion++;
+				rebuildSchedule();
+				audioEngine->unregisterComponent(component, this);
 			}
 			audioObjects.remove(audioObject);
 			break;
@@ -32,62 +85,67 @@ void AudioScene::deleteSystemObject(const UObject* uobject)
 	}
 }
 
-void AudioScene::processSceneAudio(float* buffer, size_t frames)
+void AudioScene::processSceneAudio(ABus& bus, size_t frames, AudioWorkerPool& workers)
 {
+	// find the schedule compiled for the currently connected graph. Newer schedules may already
+	// have been published for components that are not connected yet.
+	const ProcessSchedule* schedule = latestSchedule.load(std::memory_order_acquire);
+	while (schedule && schedule->version > connectedVersion) schedule = schedule->previous;
+	if (!schedule || schedule->version != connectedVersion) return;
+	processedVersion.store(connectedVersion, std::memory_order_release);
+
 	if (outputComponents.empty()) return;
 
-	struct ProcessQueueItem
-	{
-		ADelayLine* delayline;
-		size_t remaining;
-	};
-	std::queue<ProcessQueueItem> processQueue;
+	updateVoices(*schedule);
 
-	for (auto* c : outputComponents) {
-		for (const auto& input : c->inputs) {
-			processQueue.push({ input.get(), std::min(frames - input->readable(), frames) });
-		}
-	}
-	for (auto* c : auralizingComponents) {
-		for (const auto& input : c->inputs) {
-			processQueue.push({ input.get(), std::min(frames - input->readable(), frames) });
-		}
-	}
+	for (size_t level = 0; level + 1 < schedule->levelOffsets.size(); level++) {
+		const size_t levelBegin = schedule->levelOffsets[level];
+		auto processTask = [schedule, levelBegin, frames](size_t i) {
+			const auto& task = schedule->tasks[levelBegin + i];
+			AudioTimerScope timerScope(task.source->processTimer.get());
+			for (size_t d = task.begin; d < task.end; d++) {
+				ADelayLine* delayline = schedule->delaylines[d];
+				size_t remaining = frames - std::min(delayline->readable(), frames);
 
-	while (!processQueue.empty()) {
-		auto& dependency = processQueue.front();
-		size_t n = dependency.delayline->source->process(dependency.delayline, dependency.remaining);
-		if (n < dependency.remaining) {
-			// we haven't processed all required samples yet
-			dependency.remaining -= n;
-			for (const auto& dependencyInput : dependency.delayline->source->inputs) {
-				if (dependencyInput->readable() < dependency.remaining) {
-					// This input is holding us up, add to queue
-					processQueue.push({ dependencyInput.get(), dependency.remaining - dependencyInput->readable() });
+				// virtual connections are processed normally until faded out
+				const bool bSkip = delayline->bVirtual && delayline->fadedOut();
+				while (remaining > 0) {
+					size_t n = bSkip ? task.source->processVirtual(delayline, remaining) : task.source->process(delayline, remaining);
+					if (n == 0) break;
+					remaining -= std::min(n, remaining);
 				}
 			}
-			processQueue.push(dependency);
-		}
-		processQueue.pop();
+		};
+		workers.parallelFor(schedule->levelOffsets[level + 1] - levelBegin, processTask);
 	}
 
-	for (auto* c : outputComponents) c->processOutput(buffer, frames);
-	for (auto* c : auralizingComponents) c->processIndirect(buffer, frames);
+	for (auto* c : outputComponents) {
+		AudioTimerScope timerScope(c->processTimer.get());
+		c->processOutput(bus, frames);
+	}
+	for (auto* c : auralizingComponents) {
+		AudioTimerScope timerScope(c->processTimer.get());
+		c->processIndirect(bus, frames);
+	}
 }
 
 void AudioScene::connectAudioComponent(AudioComponent* component)
 {
 	// direct connections
-	for (const auto& output : component->outputs) {
-		output->dest->inputs.push_back(output);
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t output : component->outputs) {
+		pool[output].dest->inputs.push_back(output);
+		pool.retain(output);
 	}
 
-	for (const auto& input : component->inputs) {
-		input->source->outputs.push_back(input);
+	for (uint32_t index : component->inputs) {
+		ADelayLine& input = pool[index];
+		input.source->outputs.push_back(index);
+		pool.retain(index);
 
 		// register this component with the other component's audio generator if necessary
-		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(input->source)) {
-			input->genID = gComp->addConsumer();
+		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(input.source)) {
+			input.genID = gComp->addConsumer();
 		}
 	}
 
@@ -107,19 +165,26 @@ void AudioScene::connectAudioComponent(AudioComponent* component)
 	}
 
 	components.push_back(component);
+	connectedVersion++;
 }
 
 void AudioScene::disconnectAudioComponent(AudioComponent* component)
 {
-	// direct connections
-	for (const auto& output : component->outputs) {
-		output->dest->inputs.remove(output);
+	// direct connections, which remain referenced by `component` until it is deleted
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t output : component->outputs) {
+		auto& inputs = pool[output].dest->inputs;
+		inputs.erase(std::remove(inputs.begin(), inputs.end(), output), inputs.end());
+		pool.release(output);
 	}
 
-	for (const auto& input : component->inputs) {
-		input->source->outputs.remove(input);
-		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(input->source)) {
-			gComp->removeConsumer(input->genID);
+	for (uint32_t index : component->inputs) {
+		ADelayLine& input = pool[index];
+		auto& outputs = input.source->outputs;
+		outputs.erase(std::remove(outputs.begin(), outputs.end(), index), outputs.end());
+		pool.release(index);
+		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(input.source)) {
+			gComp->removeConsumer(input.genID);
 		}
 	}
 
@@ -139,6 +204,146 @@ void AudioScene::disconnectAudioComponent(AudioComponent* component)
 	}
 
 	components.remove(component);
+	connectedVersion++;
+}
+
+void AudioScene::updateConnections()
+{
+	auto& pool = ADelayLinePool::instance();
+	const float reach = ADelayLine::maximumDistance * connectionHysteresis;
+
+	std::vector<uint32_t> added;
+	std::vector<uint32_t> removed;
+	std::vector<AudioComponent*> nearby;
+	for (AudioComponent* component : graphComponents) {
+		if (!grid->update(component)) continue;
+
+		// remove connections that moved out of reach
+		auto connections = graphConnections.find(component);
+		if (connections != graphConnections.end()) {
+			std::vector<uint32_t> indices = connections->second;
+			for (uint32_t index : indices) {
+				const ADelayLine& delayline = pool[index];
+				if (mat::dist(delayline.source->position, delayline.dest->position) > ADelayLine::maximumDistance) {
+					removeConnection(index);
+					removed.push_back(index);
+				}
+			}
+		}
+
+		// connect components that moved within reach
+		nearby.clear();
+		grid->query(component->position, reach, nearby);
+		for (AudioComponent* otherComp : nearby) {
+			if (otherComp == component) continue;
+			if (component->bAcceptsOutput && otherComp->bAcceptsInput && !isConnected(component, otherComp)) {
+				uint32_t output = addConnection(component, otherComp);
+				if (output != ADelayLinePool::invalidIndex) added.push_back(output);
+			}
+			if (component->bAcceptsInput && otherComp->bAcceptsOutput && !isConnected(otherComp, component)) {
+				uint32_t input = addConnection(otherComp, component);
+				if (input != ADelayLinePool::invalidIndex) added.push_back(input);
+			}
+		}
+	}
+
+	if (added.empty() && removed.empty()) return;
+
+	// New delay lines are initialized before the audio thread can reach them, with a resampler suited to
+	// the speed they are connected at. The lists and consumer tables they are added to are grown here, since growing them on
+	// the audio thread would allocate.
+	const float sampleRate = audioEngine->currentSampleRate();
+	std::vector<ListStorage> listStorage;
+	std::vector<ConsumerStorage> consumerStorage;
+	for (uint32_t index : added) {
+		ADelayLine& delayline = pool[index];
+		float speed = mat::dist(delayline.source->velocity, delayline.dest->velocity);
+		if (speed >= sinc16Speed) delayline.setResampleQuality(AResampleQuality::Sinc16);
+		else if (speed >= sinc8Speed) delayline.setResampleQuality(AResampleQuality::Sinc8);
+		delayline.init(sampleRate);
+		reserveList(delayline.source, false, listStorage);
+		reserveList(delayline.dest, true, listStorage);
+
+		// each output of a generating source reads through its own consumer
+		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(delayline.source)) {
+			ConsumerStorage consumers{ gComp, {} };
+			if (gComp->reserveConsumers(connectionCount(delayline.source, false), consumers.storage)) {
+				consumerStorage.push_back(std::move(consumers));
+			}
+		}
+	}
+
+	if (!removed.empty()) pendingReleases.push_back(removed);
+	graphVersion++;
+	rebuildSchedule(std::move(added), std::move(removed), std::move(listStorage), std::move(consumerStorage));
+	audioEngine->changeConnections(this);
+}
+
+bool AudioScene::applyConnectionChanges()
+{
+	const ProcessSchedule* schedule = latestSchedule.load(std::memory_order_acquire);
+	while (schedule && schedule->version > connectedVersion + 1) schedule = schedule->previous;
+	connectedVersion++;
+	if (!schedule || schedule->version != connectedVersion) return false;
+
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t index : schedule->removedConnections) {
+		ADelayLine& delayline = pool[index];
+		auto& outputs = delayline.source->outputs;
+		outputs.erase(std::remove(outputs.begin(), outputs.end(), index), outputs.end());
+		auto& inputs = delayline.dest->inputs;
+		inputs.erase(std::remove(inputs.begin(), inputs.end(), index), inputs.end());
+		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(delayline.source)) {
+			gComp->removeConsumer(delayline.genID);
+		}
+
+		// the reference of the source list is left for releaseRemovedConnections()
+		pool.release(index);
+	}
+
+	// the storage holds at least the remaining delay lines, so moving them does not allocate
+	for (ListStorage& list : schedule->listStorage) {
+		auto& entries = list.bInputs ? list.component->inputs : list.component->outputs;
+		list.storage.assign(entries.begin(), entries.end());
+		entries.swap(list.storage);
+	}
+	for (ConsumerStorage& consumers : schedule->consumerStorage) {
+		consumers.component->swapConsumerStorage(consumers.storage);
+	}
+
+	for (uint32_t index : schedule->addedConnections) {
+		ADelayLine& delayline = pool[index];
+		if (auto* gComp = dynamic_cast<GeneratingAudioComponent*>(delayline.source)) {
+			delayline.genID = gComp->addConsumer();
+		}
+
+		// the source list takes over the reference held since creation
+		delayline.source->outputs.push_back(index);
+		delayline.dest->inputs.push_back(index);
+		pool.retain(index);
+	}
+
+	return !schedule->removedConnections.empty();
+}
+
+void AudioScene::releaseRemovedConnections()
+{
+	if (pendingReleases.empty()) return;
+
+	// both components of each delay line are still alive, since their deletion is signalled after this
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t index : pendingReleases.front()) {
+		pool[index].deinit();
+		pool.release(index);
+	}
+	pendingReleases.pop_front();
+}
+
+const std::vector<uint32_t>& AudioScene::connectionsOf(const AudioComponent* component) const
+{
+	static const std::vector<uint32_t> none;
+	auto connections = graphConnections.find(component);
+	return connections != graphConnections.end() ? connections->second : none;
 }
 
 size_t AudioScene::registeredComponentCount() const
@@ -146,6 +351,210 @@ size_t AudioScene::registeredComponentCount() const
 	return components.size();
 }
 
+size_t AudioScene::scheduleRebuildCount() const
+{
+	return scheduleRebuilds.load(std::memory_order_relaxed);
+}
+
+void AudioScene::setVoiceBudget(size_t voices)
+{
+	voiceBudget.store(voices, std::memory_order_relaxed);
+}
+
+void AudioScene::setAudibilityThreshold(float threshold)
+{
+	audibilityThreshold.store(threshold, std::memory_order_relaxed);
+}
+
+size_t AudioScene::virtualVoiceCount() const
+{
+	return virtualVoices.load(std::memory_order_relaxed);
+}
+
+void AudioScene::updateVoices(const ProcessSchedule& schedule)
+{
+	const size_t count = schedule.delaylines.size();
+	const size_t budget = voiceBudget.load(std::memory_order_relaxed);
+	const float threshold = audibilityThreshold.load(std::memory_order_relaxed);
+
+	// collect the audibility of connections above the threshold, favouring connections that are already real
+	size_t audible = 0;
+	for (size_t d = 0; d < count; d++) {
+		const ADelayLine* delayline = schedule.delaylines[d];
+		float audibility = delayline->source->audibility(*delayline);
+		if (!delayline->bVirtual) audibility *= voiceHysteresis;
+		schedule.audibility[d] = audibility;
+		if (audibility >= threshold) schedule.ranking[audible++] = audibility;
+	}
+
+	// if there are more audible connections than the budget allows, only keep the loudest
+	float cutoff = threshold;
+	if (audible > budget) {
+		if (budget == 0) {
+			cutoff = std::numeric_limits<float>::infinity();
+		}
+		else {
+			auto nth = schedule.ranking.begin() + (budget - 1);
+			std::nth_element(schedule.ranking.begin(), nth, schedule.ranking.begin() + audible, std::greater<float>());
+			cutoff = std::max(cutoff, *nth);
+		}
+	}
+
+	size_t virtualCount = 0;
+	for (size_t d = 0; d < count; d++) {
+		ADelayLine* delayline = schedule.delaylines[d];
+		bool bVirtual = !(schedule.audibility[d] >= cutoff);
+		if (bVirtual != delayline->bVirtual) {
+			delayline->bVirtual = bVirtual;
+			delayline->fadeTo(bVirtual ? 0.f : 1.f, voiceFadeSamples);
+		}
+		if (bVirtual) virtualCount++;
+	}
+	virtualVoices.store(virtualCount, std::memory_order_relaxed);
+}
+
+void AudioScene::rebuildSchedule(
+	std::vector<uint32_t> addedConnections,
+	std::vector<uint32_t> removedConnections,
+	std::vector<ListStorage> listStorage,
+	std::vector<ConsumerStorage> consumerStorage)
+{
+	auto schedule = std::make_unique<ProcessSchedule>();
+	schedule->version = graphVersion;
+	schedule->previous = latestSchedule.load(std::memory_order_relaxed);
+	schedule->addedConnections = std::move(addedConnections);
+	schedule->removedConnections = std::move(removedConnections);
+	schedule->listStorage = std::move(listStorage);
+	schedule->consumerStorage = std::move(consumerStorage);
+
+	// call `f` with each delay line into `c`
+	auto& pool = ADelayLinePool::instance();
+	auto forEachInput = [this, &pool](const AudioComponent* c, auto&& f) {
+		auto connections = graphConnections.find(c);
+		if (connections == graphConnections.end()) return;
+		for (uint32_t index : connections->second) {
+			ADelayLine* delayline = &pool[index];
+			if (delayline->dest == c) f(delayline);
+		}
+	};
+
+	auto isSink = [](const AudioComponent* c) {
+		return dynamic_cast<const OutputAudioComponent*>(c) || dynamic_cast<const AuralizingAudioComponent*>(c);
+	};
+
+	// Level of each component: 0 without inputs, otherwise one more than its deepest source. A component
+	// revisited while its level is still being computed closes a cycle, which is cut at that point.
+	constexpr size_t pending = static_cast<size_t>(-1);
+	std::map<const AudioComponent*, size_t> levels;
+	std::function<size_t(const AudioComponent*)> levelOf = [&](const AudioComponent* c) -> size_t {
+		auto it = levels.find(c);
+		if (it != levels.end()) return it->second == pending ? 0 : it->second;
+
+		levels[c] = pending;
+		size_t level = 0;
+		forEachInput(c, [&](ADelayLine* delayline) {
+			level = std::max(level, levelOf(delayline->source) + 1);
+		});
+		levels[c] = level;
+		return level;
+	};
+
+	// collect the delay lines that outputs depend on, walking upstream from the sinks
+	std::vector<const AudioComponent*> upstream;
+	std::set<const AudioComponent*> visited;
+	for (const auto* c : graphComponents) {
+		if (isSink(c) && visited.insert(c).second) upstream.push_back(c);
+	}
+
+	std::map<std::pair<size_t, const AudioComponent*>, std::vector<ADelayLine*>> taskDelayLines;
+	while (!upstream.empty()) {
+		const AudioComponent* c = upstream.back();
+		upstream.pop_back();
+		forEachInput(c, [&](ADelayLine* delayline) {
+			taskDelayLines[{ levelOf(delayline->source), delayline->source }].push_back(delayline);
+			if (visited.insert(delayline->source).second) upstream.push_back(delayline->source);
+		});
+	}
+
+	// flatten into levels of tasks
+	size_t currentLevel = pending;
+	for (auto& [key, delaylines] : taskDelayLines) {
+		if (key.first != currentLevel) {
+			currentLevel = key.first;
+			schedule->levelOffsets.push_back(schedule->tasks.size());
+		}
+		size_t begin = schedule->delaylines.size();
+		schedule->delaylines.insert(schedule->delaylines.end(), delaylines.begin(), delaylines.end());
+		schedule->tasks.push_back({ const_cast<AudioComponent*>(key.second), begin, schedule->delaylines.size() });
+	}
+	schedule->levelOffsets.push_back(schedule->tasks.size());
+	schedule->audibility.resize(schedule->delaylines.size());
+	schedule->ranking.resize(schedule->delaylines.size());
+
+	latestSchedule.store(schedule.get(), std::memory_order_release);
+	schedules.push_back(std::move(schedule));
+	scheduleRebuilds.fetch_add(1, std::memory_order_relaxed);
+
+	// free schedules of graph versions the audio thread has moved past
+	size_t oldestInUse = processedVersion.load(std::memory_order_acquire);
+	while (schedules.size() > 1 && schedules.front()->version < oldestInUse) {
+		schedules.pop_front();
+	}
+}
+
+uint32_t AudioScene::addConnection(AudioComponent* source, AudioComponent* dest)
+{
+	uint32_t index = ADelayLinePool::instance().create(source, dest);
+	if (index == ADelayLinePool::invalidIndex) return index;
+	graphConnections[source].push_back(index);
+	graphConnections[dest].push_back(index);
+	return index;
+}
+
+void AudioScene::removeConnection(uint32_t index)
+{
+	const ADelayLine& delayline = ADelayLinePool::instance()[index];
+	for (const AudioComponent* c : { delayline.source, delayline.dest }) {
+		auto connections = graphConnections.find(c);
+		if (connections == graphConnections.end()) continue;
+		auto& indices = connections->second;
+		indices.erase(std::remove(indices.begin(), indices.end(), index), indices.end());
+	}
+}
+
+bool AudioScene::isConnected(const AudioComponent* source, const AudioComponent* dest) const
+{
+	auto connections = graphConnections.find(source);
+	if (connections == graphConnections.end()) return false;
+	auto& pool = ADelayLinePool::instance();
+	return std::any_of(connections->second.begin(), connections->second.end(), [&pool, source, dest](uint32_t index) {
+		return pool[index].source == source && pool[index].dest == dest;
+	});
+}
+
+size_t AudioScene::connectionCount(const AudioComponent* component, bool bInputs) const
+{
+	auto& pool = ADelayLinePool::instance();
+	const auto& connections = connectionsOf(component);
+	return std::count_if(connections.begin(), connections.end(), [&pool, component, bInputs](uint32_t index) {
+		return (bInputs ? pool[index].dest : pool[index].source) == component;
+	});
+}
+
+void AudioScene::reserveList(AudioComponent* component, bool bInputs, std::vector<ListStorage>& listStorage)
+{
+	const size_t required = connectionCount(component, bInputs);
+
+	auto& capacities = listCapacities[component];
+	size_t& capacity = bInputs ? capacities.first : capacities.second;
+	if (required <= capacity) return;
+
+	capacity = std::max(required, capacity * 2);
+	ListStorage list{ component, bInputs, {} };
+	list.storage.reserve(capacity);
+	listStorage.push_back(std::move(list));
+}
+
 SystemObjectInterface* AudioScene::addSystemObject(SystemObjectInterface* object)
 {
 	audioObjects.emplace_back(static_cast<AudioObject*>(object));
@@ -154,37 +563,20 @@ SystemObjectInterface* AudioScene::addSystemObject(SystemObjectInterface* object
 
 AudioComponent* AudioScene::addAudioComponentToObject(std::unique_ptr<class AudioComponent> component, AudioObject* object)
 {
-	// setup delay lines to other components, without modifying the other components
-	auto* genComp = dynamic_cast<GeneratingAudioComponent*>(component.get());
+	// setup indirect sends to other components, without modifying the other components
 	auto* auralComp = dynamic_cast<AuralizingAudioComponent*>(component.get());
 	auto* outComp = dynamic_cast<OutputAudioComponent*>(component.get());
 
-	for (AudioComponent* otherComp : components) {
-		// outputs
-		if (component->bAcceptsOutput && otherComp->bAcceptsInput) {
-			// direct send
-			auto output = std::make_shared<ADelayLine>(component.get(), otherComp);
-			if (genComp) output->genID = genComp->addConsumer();
-			component->outputs.push_back(output);
-			
-			// indirect send
-			if (auto* otherOutComp = dynamic_cast<OutputAudioComponent*>(otherComp)) {
-				if (auralComp) {
+	if (auralComp || outComp) {
+		for (AudioComponent* otherComp : graphComponents) {
+			if (auralComp && component->bAcceptsOutput && otherComp->bAcceptsInput) {
+				if (auto* otherOutComp = dynamic_cast<OutputAudioComponent*>(otherComp)) {
 					auto&& indirectSend = std::make_shared<IndirectSend>(auralComp, otherOutComp);
 					auralComp->indirectSends.push_back(indirectSend);
 				}
 			}
-		}
-
-		// inputs
-		if (component->bAcceptsInput && otherComp->bAcceptsOutput) {
-			// direct receive
-			auto input = std::make_shared<ADelayLine>(otherComp, component.get());
-			component->inputs.push_back(input);
-
-			// indirect receive
-			if (auto* otherAuralComp = dynamic_cast<AuralizingAudioComponent*>(otherComp)) {
-				if (outComp) {
+			if (outComp && component->bAcceptsInput && otherComp->bAcceptsOutput) {
+				if (auto* otherAuralComp = dynamic_cast<AuralizingAudioComponent*>(otherComp)) {
 					auto&& indirectSend = std::make_shared<IndirectSend>(otherAuralComp, outComp);
 					outComp->indirectSends.push_back(indirectSend);
 				}
@@ -192,6 +584,12 @@ AudioComponent* AudioScene::addAudioComponentToObject(std::unique_ptr<class Audi
 		}
 	}
 
+	// direct sends and receives are created by the next updateConnections(), once the component
+	// has been placed, and only to the components within reach
+	graphComponents.push_back(component.get());
+	graphVersion++;
+	rebuildSchedule();
+
 	// attach component to AudioObject and pass to AudioEngine
 	object->audioComponent = component.get();
 	audioEngine->registerComponent(std::move(component), this);
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "../SystemSceneInterface.h"
+#include "Components/GeneratingAudioComponent.h"
 #include <list>
+#include <vector>
 #include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
 
 class AudioScene : public SystemSceneInterface
 {
@@ -14,14 +20,15 @@ public:
 
 	void deleteSystemObject(const class UObject* uobject) override;
 
-	template <typename T>
-	T* setAudioComponentForObject(class AudioObject* object)
+	template <typename T, typename... Args>
+	T* setAudioComponentForObject(class AudioObject* object, Args&&... args)
 	{
-		return static_cast<T*>(addAudioComponentToObject(std::make_unique<T>(), object));
+		return static_cast<T*>(addAudioComponentToObject(std::make_unique<T>(std::forward<Args>(args)...), object));
 	}
 
-	// Called from the audio thread. Process and constructively add count `frames` to the provided interleaved buffer.
-	void processSceneAudio(float* buffer, size_t frames);
+	// Called from the audio thread. Process and constructively add count `frames` to each channel of `bus`. The graph
+	// is processed following the current schedule, with independent sources processed concurrently on `workers`.
+	void processSceneAudio(class ABus& bus, size_t frames, class AudioWorkerPool& workers);
 
 	// Called from the audio thread. Connect a component to the audio graph for processing.
 	void connectAudioComponent(class AudioComponent* component);
@@ -29,15 +36,82 @@ public:
 	// Called from the audio thread. Disconnect a component from the audio graph.
 	void disconnectAudioComponent(class AudioComponent* component);
 
+	// Called outside the audio thread once per tick. Connect components that have moved within reach of
+	// each other and remove the connections of components that have moved out of reach.
+	void updateConnections();
+
+	// Called from the audio thread. Add and remove the connections changed for the next schedule. Returns
+	// true if connections were removed, which must then be freed with releaseRemovedConnections().
+	bool applyConnectionChanges();
+
+	// Called outside the audio thread. Free the oldest connections removed by applyConnectionChanges().
+	void releaseRemovedConnections();
+
+	// Called outside the audio thread. Returns the delay lines of `component` in the graph mirror, as
+	// indices into ADelayLinePool.
+	const std::vector<uint32_t>& connectionsOf(const class AudioComponent* component) const;
+
 	// Returns the number of audio components in use by the scene
 	size_t registeredComponentCount() const;
 
+	// Returns the number of times the processing schedule has been rebuilt
+	size_t scheduleRebuildCount() const;
+
+	// Set the maximum number of connections processed per block. Less audible connections are virtualized.
+	void setVoiceBudget(size_t voices);
+
+	// Virtualize connections with an audibility below `threshold`, regardless of the voice budget
+	void setAudibilityThreshold(float threshold);
+
+	// Returns the number of virtual connections in the last processed block
+	size_t virtualVoiceCount() const;
+
 private:
 
 	SystemObjectInterface* addSystemObject(SystemObjectInterface* object) override;
 
 	class AudioComponent* addAudioComponentToObject(std::unique_ptr<class AudioComponent> component, class AudioObject* object);
 
+	// Storage for the inputs or outputs list of a component, reserved outside the audio thread
+	struct ListStorage
+	{
+		class AudioComponent* component;
+		bool bInputs;
+		std::vector<uint32_t> storage;
+	};
+
+	// Storage for the consumer table of a generating component, reserved outside the audio thread
+	struct ConsumerStorage
+	{
+		GeneratingAudioComponent* component;
+		GeneratingAudioComponent::ConsumerStorage storage;
+	};
+
+	// Called outside the audio thread. Compile the graph into a new processing schedule and publish it,
+	// along with the delay lines added to and removed from the graph since the previous schedule.
+	void rebuildSchedule(
+		std::vector<uint32_t> addedConnections = {},
+		std::vector<uint32_t> removedConnections = {},
+		std::vector<ListStorage> listStorage = {},
+		std::vector<ConsumerStorage> consumerStorage = {});
+
+	// Called outside the audio thread. Create a delay line from `source` to `dest` in the graph mirror.
+	// Returns its index, or ADelayLinePool::invalidIndex if the pool is full.
+	uint32_t addConnection(class AudioComponent* source, class AudioComponent* dest);
+
+	// Called outside the audio thread. Remove the delay line at `index` from the graph mirror.
+	void removeConnection(uint32_t index);
+
+	// Returns true if the graph mirror contains a delay line from `source` to `dest`
+	bool isConnected(const class AudioComponent* source, const class AudioComponent* dest) const;
+
+	// Number of delay lines into (`bInputs` == true) or out of `component` in the graph mirror
+	size_t connectionCount(const class AudioComponent* component, bool bInputs) const;
+
+	// Called outside the audio thread. Add storage to `listStorage` if the inputs or outputs list of
+	// `component` is too small for its delay lines in the graph mirror.
+	void reserveList(class AudioComponent* component, bool bInputs, std::vector<ListStorage>& listStorage);
+
 	class AudioEngine* const audioEngine;
 
 	std::list<std::unique_ptr<class AudioObject>> audioObjects;
@@ -52,4 +126,96 @@ private:
 	// This list contains all AuralizingAudioComponents. Pointers to
 	// these objects also exists in the `components` list.
 	std::list<class AuralizingAudioComponent*> auralizingComponents;
+
+	// A processing schedule is the graph compiled into levels of tasks. Each task fills the delay lines of one
+	// source component, and the tasks of one level only depend on tasks of earlier levels, so they are
+	// processed concurrently. Keeping each source in a single task keeps its own state single-threaded.
+	struct ProcessSchedule
+	{
+		struct Task
+		{
+			class AudioComponent* source;
+
+			// Range of this task's delay lines in `delaylines`
+			size_t begin;
+			size_t end;
+		};
+
+		// Graph version this schedule was compiled for
+		size_t version;
+
+		// Schedule of the previous graph version, until it is freed
+		const ProcessSchedule* previous;
+
+		// Delay lines to fill, grouped by task
+		std::vector<class ADelayLine*> delaylines;
+
+		// Tasks ordered by level
+		std::vector<Task> tasks;
+
+		// Delay lines connected and disconnected by updateConnections() since the previous version. The
+		// audio thread adds them to or removes them from the component lists before using this schedule.
+		std::vector<uint32_t> addedConnections;
+		std::vector<uint32_t> removedConnections;
+
+		// Larger storage for the component lists that the added delay lines would outgrow. The audio thread
+		// moves each list into its storage, and the old storage is freed along with the schedule.
+		mutable std::vector<ListStorage> listStorage;
+
+		// Likewise for the consumer tables of generating sources of the added delay lines
+		mutable std::vector<ConsumerStorage> consumerStorage;
+
+		// Index of the first task of each level, followed by the number of tasks
+		std::vector<size_t> levelOffsets;
+
+		// Scratch space for voice selection, one entry per delay line. Only used on the audio thread.
+		mutable std::vector<float> audibility;
+		mutable std::vector<float> ranking;
+	};
+
+	// Called from the audio thread. Estimate the audibility of every scheduled connection, and
+	// virtualize or restore connections to keep the most audible ones within the voice budget.
+	void updateVoices(const ProcessSchedule& schedule);
+
+	// Mirror of the graph as seen from outside the audio thread, from which schedules are compiled
+	std::vector<class AudioComponent*> graphComponents;
+
+	// Delay lines of each component of the graph mirror, as indices into ADelayLinePool. Every delay
+	// line is listed under both its source and its destination.
+	std::unordered_map<const class AudioComponent*, std::vector<uint32_t>> graphConnections;
+
+	// Capacity of the inputs and outputs lists of each graph component, as reserved by reserveList()
+	std::unordered_map<const class AudioComponent*, std::pair<size_t, size_t>> listCapacities;
+
+	// Positions of the graph components, so that only components within reach are connected
+	std::unique_ptr<class AudioSpatialGrid> grid;
+
+	// Delay lines removed by each schedule with removals, oldest first, until the audio thread has
+	// removed them from the component lists and releaseRemovedConnections() frees them
+	std::list<std::vector<uint32_t>> pendingReleases;
+
+	// Incremented outside the audio thread with each component added to or removed from the graph,
+	// and with each batch of connections changed by updateConnections()
+	size_t graphVersion;
+
+	// Incremented on the audio thread with each component connected or disconnected, and with each
+	// batch of connection changes applied. A schedule may only be used once this matches its version.
+	size_t connectedVersion;
+
+	// All compiled schedules that may still be in use, oldest first. Owned outside the audio thread.
+	std::list<std::unique_ptr<ProcessSchedule>> schedules;
+
+	// Most recently compiled schedule, which may be ahead of the connected graph
+	std::atomic<const ProcessSchedule*> latestSchedule;
+
+	// Oldest graph version the audio thread may still process. Older schedules are freed.
+	std::atomic<size_t> processedVersion;
+
+	std::atomic<size_t> scheduleRebuilds;
+
+	std::atomic<size_t> voiceBudget;
+
+	std::atomic<float> audibilityThreshold;
+
+	std::atomic<size_t> virtualVoices;
 };
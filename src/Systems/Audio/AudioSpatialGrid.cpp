@@ -0,0 +1,87 @@
+#include "AudioSpatialGrid.h"
+#include "Components/AudioComponent.h"
+#include <algorithm>
+#include <cmath>
+
+AudioSpatialGrid::AudioSpatialGrid(float cellSize) :
+	cellSize(cellSize)
+{
+}
+
+bool AudioSpatialGrid::update(AudioComponent* component)
+{
+	auto it = entries.find(component);
+	if (it == entries.end()) {
+		Cell cell = cellOf(component->position);
+		cells[cell].push_back(component);
+		entries[component] = { cell, component->position };
+		return true;
+	}
+
+	Entry& entry = it->second;
+	if (entry.position == component->position) return false;
+	entry.position = component->position;
+
+	Cell cell = cellOf(component->position);
+	if (!(cell == entry.cell)) {
+		removeFromCell(entry.cell, component);
+		cells[cell].push_back(component);
+		entry.cell = cell;
+	}
+	return true;
+}
+
+void AudioSpatialGrid::remove(AudioComponent* component)
+{
+	auto it = entries.find(component);
+	if (it == entries.end()) return;
+	removeFromCell(it->second.cell, component);
+	entries.erase(it);
+}
+
+void AudioSpatialGrid::query(const mat::vec3& position, float radius, std::vector<AudioComponent*>& result) const
+{
+	// visit every cell overlapping the bounding box of the sphere, only the 27 around `position`
+	// as long as the radius does not exceed the cell size
+	Cell min = cellOf(position - radius);
+	Cell max = cellOf(position + radius);
+	const float radiusSquared = radius * radius;
+
+	for (int32_t x = min.x; x <= max.x; x++) {
+		for (int32_t y = min.y; y <= max.y; y++) {
+			for (int32_t z = min.z; z <= max.z; z++) {
+				auto it = cells.find({ x, y, z });
+				if (it == cells.end()) continue;
+				for (AudioComponent* component : it->second) {
+					mat::vec3 offset = component->position - position;
+					if (mat::dot(offset, offset) <= radiusSquared) result.push_back(component);
+				}
+			}
+		}
+	}
+}
+
+size_t AudioSpatialGrid::CellHash::operator()(const Cell& cell) const
+{
+	// spatial hash of Teschner et al., spreading neighbouring cells across buckets
+	uint32_t h = static_cast<uint32_t>(cell.x) * 73856093u ^ static_cast<uint32_t>(cell.y) * 19349663u ^ static_cast<uint32_t>(cell.z) * 83492791u;
+	return static_cast<size_t>(h);
+}
+
+AudioSpatialGrid::Cell AudioSpatialGrid::cellOf(const mat::vec3& position) const
+{
+	return {
+		static_cast<int32_t>(std::floor(position.x / cellSize)),
+		static_cast<int32_t>(std::floor(position.y / cellSize)),
+		static_cast<int32_t>(std::floor(position.z / cellSize))
+	};
+}
+
+void AudioSpatialGrid::removeFromCell(const Cell& cell, AudioComponent* component)
+{
+	auto it = cells.find(cell);
+	if (it == cells.end()) return;
+	auto& list = it->second;
+	list.erase(std::remove(list.begin(), list.end(), component), list.end());
+	if (list.empty()) cells.erase(it);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../../Util/Matrix.h"
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// AudioSpatialGrid indexes audio components by position in a uniform grid of cubic cells, so the
+// components near a point are found by visiting only the cells around it, however many there are.
+class AudioSpatialGrid
+{
+public:
+
+	// `cellSize` is the largest radius supported by query()
+	AudioSpatialGrid(float cellSize);
+
+	// Add `component` at its current position, or move it there if already added. Returns false if
+	// `component` has not moved since it was last indexed.
+	bool update(class AudioComponent* component);
+
+	void remove(class AudioComponent* component);
+
+	// Append the components within `radius` of `position` to `result`
+	void query(const mat::vec3& position, float radius, std::vector<class AudioComponent*>& result) const;
+
+private:
+
+	struct Cell
+	{
+		int32_t x, y, z;
+
+		bool operator==(const Cell& other) const { return x == other.x && y == other.y && z == other.z; }
+	};
+
+	struct CellHash
+	{
+		size_t operator()(const Cell& cell) const;
+	};
+
+	struct Entry
+	{
+		Cell cell;
+
+		// Position of the component when it was last indexed
+		mat::vec3 position;
+	};
+
+	Cell cellOf(const mat::vec3& position) const;
+
+	// Remove `component` from the component list of `cell`
+	void removeFromCell(const Cell& cell, class AudioComponent* component);
+
+	float cellSize;
+
+	// Components in each non-empty cell
+	std::unordered_map<Cell, std::vector<class AudioComponent*>, CellHash> cells;
+
+	std::unordered_map<const class AudioComponent*, Entry> entries;
+};
@@ -1,6 +1,7 @@
 #include "AudioSystem.h"
 #include "AudioScene.h"
 #include "AudioEngine.h"
+#include "AWAVFile.h"
 
 AudioSystem::AudioSystem()
 {
@@ -17,6 +18,12 @@ bool AudioSystem::init()
 	return audioEngine->start();
 }
 
+bool AudioSystem::initOffline(float sampleRate, int channels)
+{
+	audioEngine = std::make_unique<AudioEngine>();
+	return audioEngine->initOffline(sampleRate, channels);
+}
+
 void AudioSystem::deinit()
 {
 	for (auto& scene : audioScenes) audioEngine->unregisterScene(scene.get());
@@ -27,6 +34,7 @@ void AudioSystem::deinit()
 
 void AudioSystem::execute(float deltaTime)
 {
+	for (auto& scene : audioScenes) scene->updateConnections();
 	audioEngine->tick(deltaTime);
 }
 
@@ -45,3 +53,44 @@ SystemSceneInterface* AudioSystem::findSystemScene(const UScene* uscene)
 	}
 	return nullptr;
 }
+
+bool AudioSystem::renderOffline(std::vector<float>& buffer, float seconds, size_t blockSize)
+{
+	if (!audioEngine || seconds <= 0.f) return false;
+
+	for (auto& scene : audioScenes) scene->updateConnections();
+
+	size_t frames = static_cast<size_t>(seconds * audioEngine->currentSampleRate());
+	buffer.clear();
+	buffer.resize(frames * audioEngine->channelCount());
+	audioEngine->render(buffer.data(), frames, blockSize);
+
+	// clean up anything the render released, as a regular tick would
+	audioEngine->tick(seconds);
+	return true;
+}
+
+AudioProfile AudioSystem::profile() const
+{
+	return AudioProfiler::instance().snapshot();
+}
+
+void AudioSystem::setDetailedProfiling(bool bEnabled)
+{
+	AudioProfiler::instance().setDetailedTiming(bEnabled);
+}
+
+void AudioSystem::resetProfile()
+{
+	AudioProfiler::instance().reset();
+}
+
+bool AudioSystem::renderOffline(std::string filepath, float seconds, size_t blockSize)
+{
+	AWAVFile wav;
+	if (!renderOffline(wav.data, seconds, blockSize)) return false;
+
+	wav.channels = static_cast<uint16_t>(audioEngine->channelCount());
+	wav.sampleRate = static_cast<uint32_t>(audioEngine->currentSampleRate());
+	return wav.save(filepath);
+}
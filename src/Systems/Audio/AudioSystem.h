@@ -1,8 +1,10 @@
 #pragma once
 
 #include "../SystemInterface.h"
+#include "AudioProfiler.h"
 #include <vector>
 #include <memory>
+#include <string>
 
 class AudioSystem : public SystemInterface
 {
@@ -19,6 +21,24 @@ public:
 	SystemSceneInterface* createSystemScene(const class UScene* uscene) override;
 	SystemSceneInterface* findSystemScene(const class UScene* uscene) override;
 
+	// Initialize the system without an audio device. Use in place of init() for offline rendering.
+	bool initOffline(float sampleRate, int channels = 2);
+
+	// Render `seconds` of all scenes into interleaved `buffer` as fast as possible. Requires initOffline().
+	bool renderOffline(std::vector<float>& buffer, float seconds, size_t blockSize = 256);
+
+	// Render `seconds` of all scenes to a 32-bit float wav file at `filepath`. Requires initOffline().
+	bool renderOffline(std::string filepath, float seconds, size_t blockSize = 256);
+
+	// Returns a snapshot of audio callback load, xruns and, if enabled, per-component processing times
+	AudioProfile profile() const;
+
+	// Enable or disable timing of individual components and convolvers
+	void setDetailedProfiling(bool bEnabled);
+
+	// Clear all collected profiling data
+	void resetProfile();
+
 private:
 
 	// AudioScene objects are shared by AudioEngine
@@ -0,0 +1,255 @@
+#include "AudioWorkerPool.h"
+#include <algorithm>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define CPU_PAUSE() _mm_pause()
+#else
+#define CPU_PAUSE() std::this_thread::yield()
+#endif
+
+// Upper bound for the default number of workers
+constexpr size_t maxDefaultWorkers = 7;
+
+// Idle workers poll this many times before going to sleep, so back-to-back jobs wake them quickly
+constexpr int workerSpinCount = 2000;
+
+// Upper bound for the number of background workers
+constexpr size_t maxBackgroundWorkers = 4;
+
+// Capacity of the background task queue
+constexpr size_t backgroundQueueSize = 1024;
+
+namespace
+{
+	// Raise the calling thread to real-time priority, `levelsBelowMax` below the highest, where
+	// permitted. Failure is not an error, the worker then simply runs at normal priority.
+	void setRealtimePriority(int levelsBelowMax)
+	{
+#if defined(_WIN32)
+		SetThreadPriority(GetCurrentThread(), levelsBelowMax <= 1 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST);
+#else
+		sched_param param = {};
+		param.sched_priority = sched_get_priority_max(SCHED_FIFO) - levelsBelowMax;
+		pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+#endif
+	}
+
+	constexpr uint64_t indexMask = 0xffffffffull;
+}
+
+AudioWorkerPool::AudioWorkerPool(size_t numWorkers) :
+	taskFn(nullptr),
+	taskContext(nullptr),
+	taskCount(0),
+	jobState(0),
+	pendingTasks(0),
+	bQuit(false)
+{
+	for (size_t i = 0; i < numWorkers; i++) {
+		workers.emplace_back([this] { workerLoop(); });
+	}
+}
+
+AudioWorkerPool::~AudioWorkerPool()
+{
+	// publish an empty job so sleeping workers wake up and see bQuit
+	bQuit.store(true);
+	taskCount.store(0, std::memory_order_relaxed);
+	jobState.fetch_add(indexMask + 1, std::memory_order_release);
+	jobState.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+size_t AudioWorkerPool::workerCount() const
+{
+	return workers.size();
+}
+
+size_t AudioWorkerPool::defaultWorkerCount()
+{
+	size_t cores = std::thread::hardware_concurrency();
+	return std::min(cores > 1 ? cores - 1 : 0, maxDefaultWorkers);
+}
+
+void AudioWorkerPool::run(size_t count, TaskFn fn, void* context)
+{
+	if (count == 0) return;
+
+	// Close the job before replacing its fields. A worker still holding the state of the previous job
+	// may read the new fields, but its claim then fails against the closed state, whose index is past
+	// any task count. The fields are stored with release, so a worker seeing any of them also sees the
+	// closed state.
+	uint64_t state = ((jobState.load(std::memory_order_relaxed) >> 32) + 1) << 32;
+	jobState.store(state | indexMask, std::memory_order_relaxed);
+	taskFn.store(fn, std::memory_order_release);
+	taskContext.store(context, std::memory_order_release);
+	taskCount.store(count, std::memory_order_release);
+	pendingTasks.store(count, std::memory_order_relaxed);
+
+	jobState.store(state, std::memory_order_release);
+	if (!workers.empty()) jobState.notify_all();
+
+	while (executeOne(state));
+
+	// barrier: wait for tasks still running on workers
+	while (pendingTasks.load(std::memory_order_acquire) != 0) CPU_PAUSE();
+}
+
+bool AudioWorkerPool::executeOne(uint64_t& state)
+{
+	while (true) {
+		// The fields may already belong to a newer job than `state`. run() closes jobState before
+		// replacing them, so the claim below then fails and is retried against the new state.
+		TaskFn fn = taskFn.load(std::memory_order_acquire);
+		void* context = taskContext.load(std::memory_order_acquire);
+		size_t count = taskCount.load(std::memory_order_acquire);
+		size_t index = static_cast<size_t>(state & indexMask);
+		if (index >= count) return false;
+
+		if (jobState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+			fn(context, index);
+			pendingTasks.fetch_sub(1, std::memory_order_release);
+			state++;
+			return true;
+		}
+	}
+}
+
+void AudioWorkerPool::workerLoop()
+{
+	setRealtimePriority(1);
+
+	uint64_t state = jobState.load(std::memory_order_acquire);
+	while (!bQuit.load(std::memory_order_relaxed)) {
+		if (executeOne(state)) continue;
+
+		// nothing left to claim, spin briefly before sleeping until the job state changes
+		uint64_t idleState = state;
+		for (int i = 0; i < workerSpinCount && state == idleState; i++) {
+			CPU_PAUSE();
+			state = jobState.load(std::memory_order_acquire);
+		}
+		if (state == idleState) {
+			jobState.wait(idleState, std::memory_order_acquire);
+			state = jobState.load(std::memory_order_acquire);
+		}
+	}
+}
+
+AudioBackgroundPool::AudioBackgroundPool(size_t numWorkers) :
+	cells(new Cell[backgroundQueueSize]),
+	cellMask(backgroundQueueSize - 1),
+	enqueuePos(0),
+	dequeuePos(0),
+	submitted(0),
+	bQuit(false)
+{
+	for (size_t i = 0; i < backgroundQueueSize; i++) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < numWorkers; i++) {
+		workers.emplace_back([this] { workerLoop(); });
+	}
+}
+
+AudioBackgroundPool::~AudioBackgroundPool()
+{
+	bQuit.store(true);
+	submitted.fetch_add(1, std::memory_order_release);
+	submitted.notify_all();
+	for (auto& worker : workers) worker.join();
+}
+
+AudioBackgroundPool& AudioBackgroundPool::instance()
+{
+	// leave the cores running the callback and its workers to them where possible
+	static AudioBackgroundPool instance(std::clamp<size_t>(std::thread::hardware_concurrency() / 2, 1, maxBackgroundWorkers));
+	return instance;
+}
+
+size_t AudioBackgroundPool::workerCount() const
+{
+	return workers.size();
+}
+
+bool AudioBackgroundPool::submit(TaskFn fn, void* context)
+{
+	// bounded MPMC queue: a cell is free for the producer whose position matches its sequence
+	size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	Cell* cell;
+	while (true) {
+		cell = &cells[pos & cellMask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		if (sequence == pos) {
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		}
+		else if (sequence < pos) {
+			return false; // the cell still holds a task from one lap ago
+		}
+		else {
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	cell->fn = fn;
+	cell->context = context;
+	cell->sequence.store(pos + 1, std::memory_order_release);
+
+	submitted.fetch_add(1, std::memory_order_release);
+	submitted.notify_one();
+	return true;
+}
+
+bool AudioBackgroundPool::pop(TaskFn& fn, void*& context)
+{
+	size_t pos = dequeuePos.load(std::memory_order_relaxed);
+	Cell* cell;
+	while (true) {
+		cell = &cells[pos & cellMask];
+		size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		if (sequence == pos + 1) {
+			if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+		}
+		else if (sequence < pos + 1) {
+			return false; // nothing has been published to this cell yet
+		}
+		else {
+			pos = dequeuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	fn = cell->fn;
+	context = cell->context;
+	cell->sequence.store(pos + cellMask + 1, std::memory_order_release);
+	return true;
+}
+
+void AudioBackgroundPool::workerLoop()
+{
+	// below the audio workers, which the callback waits on every block
+	setRealtimePriority(2);
+
+	while (true) {
+		// read before checking the queue, so a task submitted after the check changes it
+		uint32_t seen = submitted.load(std::memory_order_acquire);
+
+		TaskFn fn;
+		void* context;
+		if (pop(fn, context)) {
+			fn(context);
+			continue;
+		}
+		if (bQuit.load(std::memory_order_relaxed)) break;
+
+		for (int i = 0; i < workerSpinCount && submitted.load(std::memory_order_acquire) == seen; i++) CPU_PAUSE();
+		submitted.wait(seen, std::memory_order_acquire);
+	}
+}
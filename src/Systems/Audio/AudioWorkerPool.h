@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// AudioWorkerPool runs data-parallel work from the audio callback on pre-spawned, high-priority worker
+// threads. Tasks are claimed through a single atomic job counter, and parallelFor() returns only once
+// every task has completed, so it doubles as a barrier. Running a job takes no locks and never allocates.
+class AudioWorkerPool
+{
+public:
+
+	// Spawn `numWorkers` worker threads. The calling thread of parallelFor() executes tasks as well,
+	// so a pool without workers runs every task inline.
+	AudioWorkerPool(size_t numWorkers);
+
+	~AudioWorkerPool();
+
+	// Call `task(i)` for every i in [0, count) across the calling thread and all workers, and return
+	// once all calls have completed. Must not be called from more than one thread at a time.
+	template<typename F>
+	void parallelFor(size_t count, F& task)
+	{
+		run(count, &invoke<F>, &task);
+	}
+
+	// Number of worker threads, not including the calling thread
+	size_t workerCount() const;
+
+	// Suggested number of workers for this machine, leaving one core for the callback thread
+	static size_t defaultWorkerCount();
+
+private:
+
+	typedef void (*TaskFn)(void* context, size_t index);
+
+	template<typename F>
+	static void invoke(void* context, size_t index)
+	{
+		(*static_cast<F*>(context))(index);
+	}
+
+	// Publish a job and help execute it until every task has completed
+	void run(size_t count, TaskFn fn, void* context);
+
+	// Claim and execute one task of the job described by `state`. Returns false if no task is left.
+	bool executeOne(uint64_t& state);
+
+	// Main loop of each worker thread
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+
+	// Current job. Only written while jobState is closed, so no task can be claimed with them.
+	std::atomic<TaskFn> taskFn;
+	std::atomic<void*> taskContext;
+	std::atomic<size_t> taskCount;
+
+	// Job generation in the upper 32 bits, index of the next unclaimed task in the lower 32 bits
+	alignas(64) std::atomic<uint64_t> jobState;
+
+	// Number of tasks of the current job that have not yet completed
+	alignas(64) std::atomic<size_t> pendingTasks;
+
+	std::atomic<bool> bQuit;
+};
+
+// AudioBackgroundPool runs tasks submitted by the audio thread on worker threads of lower priority than
+// the audio workers, for work whose result is only due in a later callback. Tasks pass through a bounded
+// lock-free queue, so submitting never blocks or allocates. Tasks still queued on destruction are run.
+class AudioBackgroundPool
+{
+public:
+
+	typedef void (*TaskFn)(void* context);
+
+	// Spawn `numWorkers` worker threads
+	AudioBackgroundPool(size_t numWorkers);
+
+	~AudioBackgroundPool();
+
+	// Queue `fn(context)` to run on a worker. Safe to call from any number of threads. Returns false
+	// if the queue is full, in which case the caller is responsible for the task.
+	bool submit(TaskFn fn, void* context);
+
+	// Number of worker threads
+	size_t workerCount() const;
+
+	// Shared pool of all audio components. The workers are spawned on first use, which
+	// should therefore not happen on the audio thread.
+	static AudioBackgroundPool& instance();
+
+private:
+
+	// Slot of the task queue. `sequence` tells producers and consumers whose turn it is.
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		TaskFn fn;
+		void* context;
+	};
+
+	// Dequeue the oldest task. Returns false if the queue is empty.
+	bool pop(TaskFn& fn, void*& context);
+
+	// Main loop of each worker thread
+	void workerLoop();
+
+	std::vector<std::thread> workers;
+
+	// Ring of queued tasks. Size is a power of two.
+	std::unique_ptr<Cell[]> cells;
+	size_t cellMask;
+
+	// Absolute positions of the next enqueue and dequeue
+	alignas(64) std::atomic<size_t> enqueuePos;
+	alignas(64) std::atomic<size_t> dequeuePos;
+
+	// Incremented after every submit, which idle workers wait on
+	alignas(64) std::atomic<uint32_t> submitted;
+
+	std::atomic<bool> bQuit;
+};
@@ -1,21 +1,53 @@
 #include "AMicrophone.h"
-#include "../DSP/ADelayLine.h"
+#include "../DSP/ADelayLinePool.h"
+#include "../DSP/ASIMD.h"
+#include <algorithm>
 
-AMicrophone::AMicrophone() :
-	processingBuffer(2048) // TEMP
+// Channel gains applied to an input in the previous block, ramped from in the next one
+struct MicrophoneInputGains
+{
+	float gains[ABusLayout::maxChannels];
+
+	// Number of valid gains, 0 before the first block
+	size_t count;
+
+	// True if the gains are Ambisonic encoding gains rather than speaker gains
+	bool bAmbisonic;
+};
+
+AMicrophone::AMicrophone()
 {
 	bAcceptsInput = true;
 	bAcceptsOutput = false;
 }
 
+AMicrophone::AMicrophone(size_t ambisonicOrder) :
+	AMicrophone()
+{
+	setAmbisonicOrder(ambisonicOrder);
+}
+
 void AMicrophone::init(float sampleRate)
 {
 	OutputAudioComponent::init(sampleRate);
 }
 
-void AMicrophone::transformUpdated()
+void AMicrophone::initDelayLineData(ADelayLine* delayline, float sampleRate, bool bIsSource)
 {
-	OutputAudioComponent::transformUpdated();
+	if (!bIsSource) delayline->destData = new MicrophoneInputGains{};
+}
+
+void AMicrophone::deinitDelayLineData(ADelayLine* delayline, bool bIsSource)
+{
+	if (!bIsSource) {
+		delete static_cast<MicrophoneInputGains*>(delayline->destData);
+		delayline->destData = nullptr;
+	}
+}
+
+void AMicrophone::transformUpdated(const std::vector<uint32_t>& connections)
+{
+	OutputAudioComponent::transformUpdated(connections);
 }
 
 void AMicrophone::otherTransformUpdated(const ADelayLine& connection, bool bInput)
@@ -23,21 +55,75 @@ void AMicrophone::otherTransformUpdated(const ADelayLine& connection, bool bInpu
 	OutputAudioComponent::otherTransformUpdated(connection, bInput);
 }
 
-size_t AMicrophone::processOutput(float* buffer, size_t n)
+size_t AMicrophone::processOutput(ABus& bus, size_t n)
 {
-	for (const auto& input : inputs) {
-		n = input->read(processingBuffer.data(), n);
-		size_t bIdx = 0;
-		for (size_t i = 0; i < n; i++) {
-			// This is all hardcoded for stereo, needs to be changed eventually
-			buffer[bIdx++] += processingBuffer[i];
-			buffer[bIdx++] += processingBuffer[i];
+	// with Ambisonics, sources are encoded into the Ambisonic bus and decoded once below, so the
+	// per-source cost only depends on the Ambisonic order
+	const size_t frames = n;
+	const bool bAmbisonic = beginAmbisonicBlock(frames);
+	ABus& target = bAmbisonic ? ambisonicBus : bus;
+	const size_t channels = target.channelCount();
+	float gains[ABusLayout::maxChannels];
+
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t index : inputs) {
+		ADelayLine* input = &pool[index];
+		auto* inputGains = static_cast<MicrophoneInputGains*>(input->destData);
+		if (!inputGains) continue;
+
+		// mix straight from the delay line storage
+		auto span = input->acquireRead(n);
+		n = span.size();
+		if (n == 0) continue;
+
+		// ramp from the previous block's gains to avoid zipper noise on movement
+		if (bAmbisonic) ambisonics::encode(ambisonicOrder, input->source->position - position, gains);
+		else calcChannelGains(input->source, bus.layout(), gains);
+		if (inputGains->count != channels || inputGains->bAmbisonic != bAmbisonic) {
+			std::copy_n(gains, channels, inputGains->gains);
+			inputGains->count = channels;
+			inputGains->bAmbisonic = bAmbisonic;
 		}
+
+		for (size_t ch = 0; ch < channels; ch++) {
+			float gain = inputGains->gains[ch];
+			if (gain == 0.f && gains[ch] == 0.f) continue;
+
+			float increment = (gains[ch] - gain) / static_cast<float>(n);
+			float* out = target.channel(ch);
+			simd::gainAccumulate(out, span.first.data(), gain, increment, span.first.size());
+			simd::gainAccumulate(
+				out + span.first.size(), span.second.data(),
+				gain + increment * static_cast<float>(span.first.size()), increment, span.second.size());
+		}
+		std::copy_n(gains, channels, inputGains->gains);
+
+		input->commitRead(n);
 	}
 
+	if (bAmbisonic) endAmbisonicBlock(bus, frames);
+
 	return n;
 }
 
+void AMicrophone::calcChannelGains(const AudioComponent* source, const ABusLayout& layout, float* gains)
+{
+	const size_t channels = layout.channels.size();
+	if (channels == 2) {
+		calcStereoGain(source, gains[0], gains[1]);
+		return;
+	}
+
+	mat::vec3 dir = source->position - position;
+	if (dir.x == 0.f && dir.z == 0.f) {
+		// directly above or below, spread evenly over all speakers
+		const float gain = 1.f / sqrtf(static_cast<float>(std::max<size_t>(layout.panOrder.size(), 1)));
+		for (size_t ch = 0; ch < channels; ch++) gains[ch] = layout.channels[ch].bLFE ? 0.f : gain;
+		return;
+	}
+	layout.pan(atan2f(dir.x, dir.z), gains);
+}
+
 void AMicrophone::calcStereoGain(const AudioComponent* source, float& gainL, float& gainR)
 {
 	mat::vec3 dir = source->position - position;
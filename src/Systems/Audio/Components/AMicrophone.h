@@ -8,19 +8,26 @@ public:
 
 	AMicrophone();
 
+	// Render through an Ambisonic bus of order `ambisonicOrder`, see setAmbisonicOrder()
+	explicit AMicrophone(size_t ambisonicOrder);
+
 	// AudioComponent interface
 	void init(float sampleRate) override;
-	void transformUpdated() override;
+	const char* name() const override { return "AMicrophone"; };
+	void initDelayLineData(class ADelayLine* delayline, float sampleRate, bool bIsSource) override;
+	void deinitDelayLineData(class ADelayLine* delayline, bool bIsSource) override;
+	void transformUpdated(const std::vector<uint32_t>& connections) override;
 	void otherTransformUpdated(const ADelayLine& connection, bool bInput) override;
 	
 	// OutputAudioComponent interface
-	size_t processOutput(float* buffer, size_t n) override;
+	size_t processOutput(class ABus& bus, size_t n) override;
 
 private:
 
 	// Calculate the stereo gain of a given source (hardcoded X+ to the right)
 	void calcStereoGain(const AudioComponent* source, float& gainL, float& gainR);
 
-	// Buffer used to copy data from input buffers
-	std::vector<float> processingBuffer;
+	// Calculate the gain of a given source for each channel of `layout`. Stereo uses calcStereoGain(),
+	// other layouts pan between the two speakers enclosing the source's horizontal direction.
+	void calcChannelGains(const AudioComponent* source, const struct ABusLayout& layout, float* gains);
 };
@@ -1,34 +1,55 @@
 #include "ASpeaker.h"
+#include "../AWAVStream.h"
+#include "../DSP/ABus.h"
 #include "../DSP/ADelayLine.h"
 #include "../DSP/AConvolver.h"
 #include "../DSP/AInterpParameter.h"
+#include "../DSP/AOscillatorBank.h"
+#include <algorithm>
 
-ASpeaker::ASpeaker() : sinGeneratorPhase(0)
+ASpeaker::ASpeaker()
 {
 	bAcceptsInput = false;
 	bAcceptsOutput = true;
 	
 	convolver = std::make_unique<AConvolver>("res/sound/auratone_8192.wav");
+
+	oscillators = std::make_unique<AOscillatorBank>();
+	oscillators->addVoice(AWaveform::Sine, 500.f, 0.3f); // sin wave
+	// oscillators->addVoice(AWaveform::WhiteNoise, 0.f, 0.3f); // white noise
+}
+
+ASpeaker::ASpeaker(const std::string& sourceFilepath, int sourceChannel) :
+	ASpeaker()
+{
+	stream = std::make_unique<AWAVStream>();
+	if (!stream->open(sourceFilepath, sourceChannel)) stream.reset(); // fall back to the oscillators
+}
+
+ASpeaker::~ASpeaker()
+{
 }
 
 void ASpeaker::init(float sampleRate)
 {
 	AuralizingAudioComponent::init(sampleRate);
 	convolver->init(sampleRate);
-	processingBuffer.clear();
-	processingBuffer.resize(2048); // TEMP
+	oscillators->init(sampleRate);
+	gainBuffer.resize(ABus::maxBlockFrames);
+	if (stream) stream->start(sampleRate, bOffline);
 }
 
 void ASpeaker::deinit()
 {
 	AuralizingAudioComponent::deinit();
 	convolver->deinit();
+	if (stream) stream->stop();
 }
 
 void ASpeaker::initDelayLineData(ADelayLine* delayline, float sampleRate, bool bIsSource)
 {
 	AInterpParameter* gain = new AInterpParameter(0.f, 0.01f);
-	gain->sampleRate = sampleRate;
+	gain->setSampleRate(sampleRate);
 	delayline->sourceData = gain;
 }
 
@@ -44,30 +65,52 @@ size_t ASpeaker::process(ADelayLine* output, size_t n)
 	size_t available = readable(output->genID);
 	if (available < n) generate(n - available);
 
-	// read generated buffer
-	size_t count = peekGenerated(output->genID, processingBuffer.data(), n);
-	n = count;
+	size_t count = peekGenerated(output->genID, gainBuffer.data(), std::min(n, gainBuffer.size()));
+	if (count == 0) return 0;
 
-	// process raw generated samples
+	// apply the gain's exponential approach to the new distance gain
 	AInterpParameter* gain = static_cast<AInterpParameter*>(output->sourceData);
 	gain->target = 0.3f / mat::dist(position, output->dest->position);
-	for (size_t i = 0; i < count; i++) processingBuffer[i] *= gain->update();
+	float gainStart = gain->current;
+	gain->apply(gainBuffer.data(), count);
+
+	size_t consumed = count;
+	size_t written = output->write(gainBuffer.data(), consumed);
+
+	// the delay line may take fewer samples, leaving the rest to the generator for the next call
+	if (consumed < count) {
+		gain->current = gainStart;
+		gain->update(consumed);
+	}
 
-	// write processed generated samples
-	size_t written = output->write(processingBuffer.data(), count);
-	
 	// notify generator of how many generated samples we ended up using
-	seekGenerated(output->genID, count);
+	seekGenerated(output->genID, consumed);
 
 	return written;
 }
 
+size_t ASpeaker::processVirtual(ADelayLine* output, size_t n)
+{
+	// skip whatever other consumers caused to be generated, so this consumer doesn't hold back the
+	// generator. If every output is virtual, nothing is generated and the source pauses.
+	seekGenerated(output->genID, readable(output->genID));
+	return output->writeSilence(n);
+}
+
+float ASpeaker::audibility(const ADelayLine& output) const
+{
+	return 0.3f / std::max(mat::dist(position, output.dest->position), 1e-3f) * generatedLevel();
+}
+
 size_t ASpeaker::generateImpl(float* buffer, size_t count)
 {
-	for (size_t i = 0; i < count; i++) {
-		buffer[i] = sinf(sinGeneratorPhase++ * 2.f * mat::pi * 500.f / sampleRate); // sin wave
-		// buffer[i] = static_cast<float>(rand()) / RAND_MAX * 2.f - 1.f; // white noise.
-		buffer[i] *= 0.3f;
+	if (stream) {
+		// the stream only comes up short if the prefetch thread falls behind or the file ended
+		size_t streamed = stream->read(buffer, count);
+		std::fill(buffer + streamed, buffer + count, 0.f);
+	}
+	else {
+		oscillators->process(buffer, count);
 	}
 	convolver->process(buffer, buffer, count);
 	return count;
@@ -2,6 +2,8 @@
 
 #include "AuralizingAudioComponent.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 class ASpeaker : public AuralizingAudioComponent
 {
@@ -9,22 +11,36 @@ public:
 
 	ASpeaker();
 
+	// Play the wav file at `sourceFilepath`, streamed from disk. `sourceChannel` selects one channel
+	// of a multichannel file, or all channels are mixed down if -1.
+	ASpeaker(const std::string& sourceFilepath, int sourceChannel = -1);
+
+	~ASpeaker();
+
 	// AudioComponent interface
 	void init(float sampleRate) override;
 	void deinit() override;
+	const char* name() const override { return "ASpeaker"; };
 	void initDelayLineData(class ADelayLine* delayline, float sampleRate, bool bIsSource) override;
 	void deinitDelayLineData(class ADelayLine* delayline, bool bIsSource) override;
 	size_t process(ADelayLine* output, size_t n) override;
+	size_t processVirtual(ADelayLine* output, size_t n) override;
+	float audibility(const ADelayLine& output) const override;
 
 private:
 
 	// Convolves the speaker signal with the speaker IR
 	std::unique_ptr<class AConvolver> convolver;
 
-	// Buffer required for process()
-	std::vector<float> processingBuffer;
+	// Generates the speaker signal
+	std::unique_ptr<class AOscillatorBank> oscillators;
+
+	// Streams the speaker signal from a file instead, if set
+	std::unique_ptr<class AWAVStream> stream;
+
+	// Generated samples of one output in process(), with the distance gain applied. Sized for ABus::maxBlockFrames.
+	std::vector<float> gainBuffer;
 
 	// GeneratingAudioComponent interface
 	size_t generateImpl(float* buffer, size_t count) override;
-	size_t sinGeneratorPhase;
 };
@@ -1,10 +1,13 @@
 #include "AudioComponent.h"
-#include "../DSP/ADelayLine.h"
+#include "../DSP/ADelayLinePool.h"
 #include "../AudioObject.h"
+#include "../AudioProfiler.h"
+#include <algorithm>
 
 AudioComponent::AudioComponent() :
 	bAcceptsInput(false),
 	bAcceptsOutput(false),
+	bOffline(false),
 	sampleRate(0.f),
 	bInitialized(false)
 {
@@ -12,32 +15,50 @@ AudioComponent::AudioComponent() :
 
 AudioComponent::~AudioComponent()
 {
+	// a connection is freed by the last component listing it
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t input : inputs) pool.release(input);
+	for (uint32_t output : outputs) pool.release(output);
 }
 
 void AudioComponent::init(float sampleRate)
 {
-	for (const auto& input : inputs) input->init(sampleRate);
-	for (const auto& output : outputs) output->init(sampleRate);
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t input : inputs) pool[input].init(sampleRate);
+	for (uint32_t output : outputs) pool[output].init(sampleRate);
 	this->sampleRate = sampleRate;
+	processTimer = AudioProfiler::instance().createTimer(name(), this);
 	bInitialized = true;
 }
 
 void AudioComponent::deinit()
 {
+	processTimer.reset();
 	bInitialized = false;
 }
 
+size_t AudioComponent::processVirtual(ADelayLine* output, size_t n)
+{
+	return output->writeSilence(n);
+}
+
+float AudioComponent::audibility(const ADelayLine& output) const
+{
+	return 1.f / std::max(mat::dist(position, output.dest->position), 1.f);
+}
+
 mat::vec3 AudioComponent::forward() const
 {
 	return mat::forward(rotation);
 }
 
-void AudioComponent::transformUpdated()
+void AudioComponent::transformUpdated(const std::vector<uint32_t>& connections)
 {
-	for (const auto& output : outputs) {
-		output->dest->otherTransformUpdated(*output, true);
-	}
-	for (const auto& input : inputs) {
-		input->dest->otherTransformUpdated(*input, false);
+	// notify the other end of each connection
+	auto& pool = ADelayLinePool::instance();
+	for (uint32_t index : connections) {
+		const ADelayLine& connection = pool[index];
+		if (connection.source == this) connection.dest->otherTransformUpdated(connection, true);
+		else connection.source->otherTransformUpdated(connection, false);
 	}
 }
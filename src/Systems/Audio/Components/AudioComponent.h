@@ -2,8 +2,8 @@
 
 #include "../../../Util/Matrix.h"
 #include <vector>
-#include <list>
 #include <memory>
+#include <cstdint>
 
 class AudioComponent
 {
@@ -11,6 +11,7 @@ public:
 
 	AudioComponent();
 
+	// Releases the delay lines of this component
 	virtual ~AudioComponent();
 
 	// Initialize internal variables for current audio session
@@ -19,13 +20,16 @@ public:
 	// Clean up internals and delete any memory allocated in init()
 	virtual void deinit();
 
+	// Name of the component type, which labels its processing time in profiles
+	virtual const char* name() const { return "AudioComponent"; };
+
 	// Initialize any per-delay data for this component.
 	virtual void initDelayLineData(class ADelayLine* delayline, float sampleRate, bool bIsSource) {};
 
 	// Clean up any per-delay data for this component
 	virtual void deinitDelayLineData(class ADelayLine* delayline, bool bIsSource) {};
 
-	// Called when a connected object updates its transform. Called in the audio thread.
+	// Called when a connected object updates its transform. Called outside the audio thread.
 	// bInput == true if this is an input to the called AudioComponent, == false if output.
 	virtual void otherTransformUpdated(const class ADelayLine& connection, bool bInput) {};
 
@@ -34,17 +38,29 @@ public:
 	// input buffer shortages or doppler interpolation.
 	virtual size_t process(class ADelayLine* output, size_t n) { return n; };
 
+	// Advance past `n` samples of a virtual `output` without producing audio, keeping the delay
+	// line in time. Returns the number of samples outputted to the buffer.
+	virtual size_t processVirtual(class ADelayLine* output, size_t n);
+
+	// Estimated level of `output` at its destination, the distance gain times the source level.
+	// AudioScene virtualizes the least audible connections.
+	virtual float audibility(const class ADelayLine& output) const;
+
 	// Should this component accept input from other components?
 	bool bAcceptsInput;
 
 	// Should this component output to other components?
 	bool bAcceptsOutput;
 
-	// Inputs from other AudioComponents
-	std::list<std::shared_ptr<class ADelayLine>> inputs;
+	// True if the engine renders offline rather than to a device, so the component may do work on the
+	// audio thread that would otherwise be deferred to keep it real-time. Set before init().
+	bool bOffline;
 
-	// Outputs to other AudioComponents
-	std::list<std::shared_ptr<class ADelayLine>> outputs;
+	// Inputs from other AudioComponents, as indices into ADelayLinePool
+	std::vector<uint32_t> inputs;
+
+	// Outputs to other AudioComponents, as indices into ADelayLinePool
+	std::vector<uint32_t> outputs;
 
 	// World space position
 	mat::vec3 position;
@@ -55,11 +71,15 @@ public:
 	// World space velocity
 	mat::vec3 velocity;
 
+	// Processing time of this component, created in init()
+	std::shared_ptr<class AudioTimer> processTimer;
+
 	// Returns the world space forward vector of the owning object
 	mat::vec3 forward() const;
 
-	// Called externally after setting position
-	virtual void transformUpdated();
+	// Called externally after setting position, with the delay lines of this component as seen
+	// outside the audio thread, since `inputs` and `outputs` belong to the audio thread
+	virtual void transformUpdated(const std::vector<uint32_t>& connections);
 
 protected:
 
@@ -1,5 +1,6 @@
 #include "AuralizingAudioComponent.h"
 #include "OutputAudioComponent.h"
+#include <algorithm>
 
 IndirectSend::IndirectSend(AuralizingAudioComponent* sender, OutputAudioComponent* receiver) :
 	sender(sender),
@@ -22,16 +23,16 @@ AuralizingAudioComponent::~AuralizingAudioComponent()
 	GeneratingAudioComponent::removeConsumer(genID);
 }
 
-void AuralizingAudioComponent::transformUpdated()
+void AuralizingAudioComponent::transformUpdated(const std::vector<uint32_t>& connections)
 {
-	AudioComponent::transformUpdated();
+	AudioComponent::transformUpdated(connections);
 	for (auto& send : indirectSends) send->auralize();
 }
 
 void AuralizingAudioComponent::init(float sampleRate)
 {
 	AudioComponent::init(sampleRate);
-	processingBuffer.resize(2048); // TEMP
+	processingBuffer.resize(ABus::maxBlockFrames);
 	for (const auto& indirectSend : indirectSends) {
 		for (auto& convolver : indirectSend->convolvers) {
 			convolver.init(sampleRate);
@@ -50,8 +51,9 @@ void AuralizingAudioComponent::deinit()
 	}
 }
 
-size_t AuralizingAudioComponent::processIndirect(float* buffer, size_t n)
+size_t AuralizingAudioComponent::processIndirect(ABus& bus, size_t n)
 {
+	n = std::min(n, processingBuffer.size());
 	size_t available = GeneratingAudioComponent::readable(genID);
 	if (available < n) GeneratingAudioComponent::generate(n - available);
 	n = GeneratingAudioComponent::readGenerated(genID, processingBuffer.data(), n);
@@ -60,7 +62,7 @@ size_t AuralizingAudioComponent::processIndirect(float* buffer, size_t n)
 		size_t channels = indirectSend->convolvers.size();
 		for (size_t ch = 0; ch < channels; ch++) {
 			indirectSend->convolvers[ch].process(processingBuffer.data(), processingBuffer.data(), n);
-			// for (size_t i = 0; i < n; i++) buffer[i * channels + ch] += processingBuffer[i];
+			// simd::gainAccumulate(bus.channel(ch), processingBuffer.data(), 1.f, 0.f, n);
 		}
 	}
 
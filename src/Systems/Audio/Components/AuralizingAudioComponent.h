@@ -3,6 +3,7 @@
 #include "AudioComponent.h"
 #include "GeneratingAudioComponent.h"
 #include "../DSP/AConvolver.h"
+#include <list>
 #include <memory>
 
 // IndirectSend represents a connection from an owning AuralizingAudioComponent to an OutputAudioComponent
@@ -39,18 +40,18 @@ public:
 	// Sends to OutputAudioComponents receiving indirect sound from this component
 	std::list<std::shared_ptr<IndirectSend>> indirectSends;
 
-	// Contribute `n` frames to interleaved buffer `buffer`. Samples should be constructively
-	// added to `buffer`, rather than overridden, as `buffer` is shared by all output components.
-	size_t processIndirect(float* buffer, size_t n);
+	// Contribute `n` frames to each channel of `bus`. Samples should be constructively
+	// added to `bus`, rather than overridden, as `bus` is shared by all output components.
+	size_t processIndirect(class ABus& bus, size_t n);
 
 	// AudioComponent interface
-	virtual void transformUpdated() override;
+	virtual void transformUpdated(const std::vector<uint32_t>& connections) override;
 	virtual void init(float sampleRate) override;
 	virtual void deinit() override;
 
 private:
 
-	// This buffer is required for processIndirect()
+	// Generated samples of one block in processIndirect(), sized for ABus::maxBlockFrames
 	std::vector<float> processingBuffer;
 
 	// Unique ID which associates the AuralizingAudioComponent with the GeneratingAudioComponent
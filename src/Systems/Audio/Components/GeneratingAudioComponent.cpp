@@ -1,64 +1,109 @@
 #include "GeneratingAudioComponent.h"
+#include <algorithm>
+#include <cmath>
 
-// Hardcoded buffer capacity, may want to change this in the future
-constexpr size_t capacity = 16348;
+// Hardcoded buffer capacity, may want to change this in the future. A power of two, so that
+// absolute positions map to buffer indices with a mask.
+constexpr size_t capacity = 16384;
+
+// Factor the peak level decays by with each generated block
+constexpr float peakLevelRelease = 0.9f;
+
+// Expected number of consumers, reserved up front so adding one doesn't usually allocate
+constexpr size_t reservedConsumers = 64;
 
 GeneratingAudioComponent::GeneratingAudioComponent() :
 	genBuffer(capacity),
-	writePtr(0),
-	size(0),
-	nextConsumerID(0)
+	writePos(0),
+	minReadPos(0),
+	minReadCount(0),
+	peakLevel(1.f),
+	consumerCapacity(reservedConsumers)
 {
+	consumers.reserve(reservedConsumers);
+	freeConsumerIDs.reserve(reservedConsumers);
 }
 
 GeneratingAudioComponent::~GeneratingAudioComponent() = default;
 
 size_t GeneratingAudioComponent::generate(size_t count)
 {
+	size_t size = static_cast<size_t>(writePos - minReadPos);
 	if (capacity == size) return 0;
 	size_t f = capacity - size; // free space
 	if (count > f) count = f;
 
+	size_t writePtr = static_cast<size_t>(writePos & (capacity - 1));
 	size_t genCount;
 	if (writePtr + count > capacity) {
 		size_t nEnd = capacity - writePtr;
 		genCount = generateImpl(genBuffer.data() + writePtr, nEnd);
-		if (genCount < nEnd) {
-			writePtr += genCount;
-		}
-		else {
-			writePtr = generateImpl(genBuffer.data(), count - nEnd);
-			genCount += writePtr;
+		if (genCount == nEnd) {
+			genCount += generateImpl(genBuffer.data(), count - nEnd);
 		}
 	}
 	else {
 		genCount = generateImpl(genBuffer.data() + writePtr, count);
-		writePtr += genCount;
-		if (writePtr == capacity) writePtr = 0;
 	}
 
-	// If we added samples to the buffer, all consumers may now read
-	if (genCount > 0) {
-		for (auto& c : consumers) c.second.readable = true;
+	// track the level for audibility estimates while the samples are still in cache
+	float blockPeak = 0.f;
+	for (size_t i = 0; i < genCount; i++) {
+		blockPeak = std::max(blockPeak, std::fabs(genBuffer[(writePtr + i) & (capacity - 1)]));
 	}
+	peakLevel = std::max(blockPeak, peakLevel * peakLevelRelease);
 
-	size += genCount;
+	writePos += genCount;
+	if (minReadCount == 0) minReadPos = writePos;
 	return genCount;
 }
 
 unsigned int GeneratingAudioComponent::addConsumer()
 {
-	ConsumerData cData;
-	cData.readPtr = writePtr;
-	cData.readable = false;
-	consumers[nextConsumerID] = cData;
-	return nextConsumerID++;
+	unsigned int id;
+	if (freeConsumerIDs.empty()) {
+		id = static_cast<unsigned int>(consumers.size());
+		consumers.emplace_back();
+	}
+	else {
+		id = freeConsumerIDs.back();
+		freeConsumerIDs.pop_back();
+	}
+
+	// new consumers start reading at the next generated sample
+	consumers[id] = ConsumerData{ writePos, true };
+	if (minReadCount == 0 || minReadPos == writePos) {
+		minReadPos = writePos;
+		minReadCount++;
+	}
+	return id;
 }
 
 void GeneratingAudioComponent::removeConsumer(unsigned int consumer)
 {
-	consumers.erase(consumer);
-	updateSize();
+	ConsumerData& cData = consumers[consumer];
+	cData.bActive = false;
+	freeConsumerIDs.push_back(consumer);
+	if (cData.readPos == minReadPos && --minReadCount == 0) updateMinReadPos();
+}
+
+bool GeneratingAudioComponent::reserveConsumers(size_t count, ConsumerStorage& storage)
+{
+	if (count < consumerCapacity) return false;
+
+	consumerCapacity = std::max(count + 1, consumerCapacity * 2);
+	storage.consumers.reserve(consumerCapacity);
+	storage.freeConsumerIDs.reserve(consumerCapacity);
+	return true;
+}
+
+void GeneratingAudioComponent::swapConsumerStorage(ConsumerStorage& storage)
+{
+	// the storage holds at least the current table, so copying it does not allocate
+	storage.consumers.assign(consumers.begin(), consumers.end());
+	storage.freeConsumerIDs.assign(freeConsumerIDs.begin(), freeConsumerIDs.end());
+	consumers.swap(storage.consumers);
+	freeConsumerIDs.swap(storage.freeConsumerIDs);
 }
 
 size_t GeneratingAudioComponent::readGenerated(unsigned int consumer, float* buffer, size_t n)
@@ -68,23 +113,25 @@ size_t GeneratingAudioComponent::readGenerated(unsigned int consumer, float* buf
 }
 
 size_t GeneratingAudioComponent::peekGenerated(unsigned int consumer, float* buffer, size_t n)
+{
+	auto span = peekGenerated(consumer, n);
+	std::copy(span.first.begin(), span.first.end(), buffer);
+	std::copy(span.second.begin(), span.second.end(), buffer + span.first.size());
+	return span.size();
+}
+
+ARingSpan<const float> GeneratingAudioComponent::peekGenerated(unsigned int consumer, size_t n)
 {
 	size_t readCount = readable(consumer);
-	if (readCount == 0) return 0;
 	if (n > readCount) n = readCount;
 
-	size_t readPtr = consumers.at(consumer).readPtr;
-	if (readPtr + n > capacity) {
-		size_t nEnd = capacity - readPtr;
-		size_t nFront = n - nEnd;
-		std::copy_n(genBuffer.data() + readPtr, nEnd, buffer);
-		std::copy_n(genBuffer.data(), nFront, buffer + nEnd);
-	}
-	else {
-		std::copy_n(genBuffer.data() + readPtr, n, buffer);
-	}
+	size_t readPtr = static_cast<size_t>(consumers[consumer].readPos & (capacity - 1));
+	size_t nEnd = std::min(n, capacity - readPtr);
 
-	return n;
+	ARingSpan<const float> span;
+	span.first = std::span<const float>(genBuffer.data() + readPtr, nEnd);
+	span.second = std::span<const float>(genBuffer.data(), n - nEnd);
+	return span;
 }
 
 size_t GeneratingAudioComponent::seekGenerated(unsigned int consumer, size_t n)
@@ -94,35 +141,39 @@ size_t GeneratingAudioComponent::seekGenerated(unsigned int consumer, size_t n)
 	if (readCount == 0) return 0;
 	if (n > readCount) n = readCount;
 
-	ConsumerData& cData = consumers.at(consumer);
-	cData.readPtr += n;
-	if (cData.readPtr >= capacity) cData.readPtr -= capacity;
-	if (cData.readPtr == writePtr) cData.readable = false;
-	
-	// If this consumer had the largest pending sample count, we
-	// may be able to update (i.e. decrease) the overall buffer size
-	if (readCount == size) updateSize();
+	ConsumerData& cData = consumers[consumer];
+
+	// If this was the last consumer at the smallest read position, the
+	// overall buffer size may decrease
+	bool bWasMinimum = cData.readPos == minReadPos;
+	cData.readPos += n;
+	if (bWasMinimum && --minReadCount == 0) updateMinReadPos();
 
 	return n;
 }
 
 size_t GeneratingAudioComponent::readable(unsigned int consumer)
 {
-	ConsumerData& cData = consumers.at(consumer);
-	if (!cData.readable) return 0;
-	if (writePtr > cData.readPtr) {
-		return writePtr - cData.readPtr;
-	}
-	else {
-		return capacity - cData.readPtr + writePtr;
-	}
+	return static_cast<size_t>(writePos - consumers[consumer].readPos);
+}
+
+float GeneratingAudioComponent::generatedLevel() const
+{
+	return peakLevel;
 }
 
-void GeneratingAudioComponent::updateSize()
+void GeneratingAudioComponent::updateMinReadPos()
 {
-	size = 0;
+	minReadPos = writePos;
+	minReadCount = 0;
 	for (const auto& c : consumers) {
-		size_t cSize = readable(c.first);
-		if (cSize > size) size = cSize;
+		if (!c.bActive) continue;
+		if (c.readPos < minReadPos || minReadCount == 0) {
+			minReadPos = c.readPos;
+			minReadCount = 1;
+		}
+		else if (c.readPos == minReadPos) {
+			minReadCount++;
+		}
 	}
 }
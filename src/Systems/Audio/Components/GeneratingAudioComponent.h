@@ -1,8 +1,9 @@
 #pragma once
 
 #include "AudioComponent.h"
+#include "../DSP/ARingSpan.h"
 #include <vector>
-#include <map>
+#include <cstdint>
 
 class GeneratingAudioComponent
 {
@@ -22,6 +23,31 @@ public:
 	// Remove a consumer from this generator
 	void removeConsumer(unsigned int consumer);
 
+	struct ConsumerData
+	{
+		// Absolute position of the next sample to read, counted from the first generated sample
+		uint64_t readPos;
+
+		// False if this slot's ID has been released by removeConsumer()
+		bool bActive;
+	};
+
+	// Storage for the consumer table, allocated outside the audio thread
+	struct ConsumerStorage
+	{
+		std::vector<ConsumerData> consumers;
+		std::vector<unsigned int> freeConsumerIDs;
+	};
+
+	// Called outside the audio thread before up to `count` consumers are connected through delay lines. Returns
+	// true and larger storage in `storage` if the consumer table may be too small, since growing it on
+	// the audio thread would allocate. One slot is kept beyond `count` for the component's own consumer.
+	bool reserveConsumers(size_t count, ConsumerStorage& storage);
+
+	// Called on the audio thread. Move the consumer table into `storage` from reserveConsumers(), which
+	// is left holding the old table.
+	void swapConsumerStorage(ConsumerStorage& storage);
+
 	// Read `n` samples into a consumer's buffer and move the read pointer.
 	// Returns the number of samples successfully written to `buffer`.
 	size_t readGenerated(unsigned int consumer, float* buffer, size_t n);
@@ -30,6 +56,10 @@ public:
 	// Returns the number of samples successfully written to `buffer`.
 	size_t peekGenerated(unsigned int consumer, float* buffer, size_t n);
 
+	// Return up to `n` of the consumer's unread samples in place, without moving the read pointer.
+	// The spans remain valid until the next call to generate().
+	ARingSpan<const float> peekGenerated(unsigned int consumer, size_t n);
+
 	// Move the consumer's read pointer by `n` samples.
 	// Returns the number of samples successfully seeked.
 	size_t seekGenerated(unsigned int consumer, size_t n);
@@ -37,34 +67,42 @@ public:
 	// The number of samples available for this consumer to read
 	size_t readable(unsigned int consumer);
 
+	// Recent peak level of generated samples, decaying between blocks. Starts at full scale, and
+	// holds its value while nothing is generated.
+	float generatedLevel() const;
+
 private:
 
 	// This function should fill the provided buffer with `count` generated
 	// samples, returning the number of successfully generated samples.
 	virtual size_t generateImpl(float* buffer, size_t count) = 0;
 
-	struct ConsumerData
-	{
-		size_t readPtr;
-		bool readable;
-	};
+	// Consumers indexed by ID. Released IDs are reused, so the array stays dense.
+	std::vector<ConsumerData> consumers;
 
-	// Maps consumers to their buffer read index
-	std::map<unsigned int, ConsumerData> consumers;
+	// IDs of inactive slots in `consumers`
+	std::vector<unsigned int> freeConsumerIDs;
 
 	// Stores generated samples for reading
 	std::vector<float> genBuffer;
 
-	// Index of the next write index
-	size_t writePtr;
+	// Absolute position of the next generated sample
+	uint64_t writePos;
+
+	// Smallest readPos of any active consumer, or writePos if there is none. Samples before
+	// this position have been read by every consumer and may be overwritten.
+	uint64_t minReadPos;
+
+	// Number of active consumers at minReadPos
+	size_t minReadCount;
 
-	// Number of valid samples in buffer
-	size_t size;
+	// Peak level of recently generated samples
+	float peakLevel;
 
-	// Simple consumer ID generator, increment each time a consumer is added
-	unsigned int nextConsumerID;
+	// Capacity of `consumers` and `freeConsumerIDs`. Only accessed outside the audio thread.
+	size_t consumerCapacity;
 
-	// Iterate through all consumers and set the size of the buffer to the largest
-	// number of pending unread samples
-	void updateSize();
+	// Recompute minReadPos and minReadCount from all active consumers. Only needed once the
+	// last consumer at the minimum moves on, so at most once per block rather than per read.
+	void updateMinReadPos();
 };
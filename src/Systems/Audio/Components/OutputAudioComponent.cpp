@@ -1,7 +1,10 @@
 #include "OutputAudioComponent.h"
 #include "AuralizingAudioComponent.h"
+#include <algorithm>
 
-OutputAudioComponent::OutputAudioComponent()
+OutputAudioComponent::OutputAudioComponent() :
+	ambisonicOrder(0),
+	requestedAmbisonicOrder(0)
 {
 }
 
@@ -9,8 +12,42 @@ OutputAudioComponent::~OutputAudioComponent()
 {
 }
 
-void OutputAudioComponent::transformUpdated()
+void OutputAudioComponent::setAmbisonicOrder(size_t order)
 {
-	AudioComponent::transformUpdated();
+	requestedAmbisonicOrder = std::min(order, ambisonics::maxOrder);
+}
+
+void OutputAudioComponent::init(float sampleRate)
+{
+	AudioComponent::init(sampleRate);
+	ambisonicOrder = requestedAmbisonicOrder;
+	if (ambisonicOrder > 0) {
+		ambisonicBus.init(ambisonics::channelCount(ambisonicOrder), ABus::maxBlockFrames);
+	}
+}
+
+void OutputAudioComponent::deinit()
+{
+	AudioComponent::deinit();
+	ambisonicBus.init(0, 0);
+}
+
+bool OutputAudioComponent::beginAmbisonicBlock(size_t frames)
+{
+	if (ambisonicOrder == 0 || frames > ambisonicBus.maxFrames()) return false;
+	ambisonicBus.clear(frames);
+	return true;
+}
+
+void OutputAudioComponent::endAmbisonicBlock(ABus& bus, size_t frames)
+{
+	// the decode matrix is stored inline, so a layout change does not allocate
+	if (!ambisonicDecoder.matches(ambisonicOrder, bus.layout())) ambisonicDecoder.init(ambisonicOrder, bus.layout());
+	ambisonicDecoder.decode(ambisonicBus, bus, frames);
+}
+
+void OutputAudioComponent::transformUpdated(const std::vector<uint32_t>& connections)
+{
+	AudioComponent::transformUpdated(connections);
 	for (auto send : indirectSends) send->auralize();
 }
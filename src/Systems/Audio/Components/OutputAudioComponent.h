@@ -1,6 +1,9 @@
 #pragma once
 
 #include "AudioComponent.h"
+#include "../DSP/ABus.h"
+#include "../DSP/AAmbisonics.h"
+#include <list>
 
 // OutputAudioComponent is an AudioComponent which will be used to fill
 // the final output buffer, to be sent directly to the output device
@@ -12,13 +15,42 @@ public:
 
 	virtual ~OutputAudioComponent();
 
-	// Contribute `n` frames to interleaved buffer `buffer`. Samples should be constructively
-	// added to `buffer`, rather than overridden, as `buffer` is shared by all output components.
-	virtual size_t processOutput(float* buffer, size_t n) = 0;
+	// Contribute `n` frames to each channel of `bus`. Samples should be constructively
+	// added to `bus`, rather than overridden, as `bus` is shared by all output components.
+	virtual size_t processOutput(class ABus& bus, size_t n) = 0;
+
+	// Encode sources into an Ambisonic bus of order `order` (at most ambisonics::maxOrder) and decode it
+	// once per block to the output layout, or pan directly to the output layout if `order` is 0.
+	// Applied on next init().
+	void setAmbisonicOrder(size_t order);
 
 	// AudioComponent interface
-	virtual void transformUpdated() override;
+	virtual void init(float sampleRate) override;
+	virtual void deinit() override;
+	virtual void transformUpdated(const std::vector<uint32_t>& connections) override;
 
 	// Connections to all AuralizingAudioComponents
 	std::list<std::shared_ptr<struct IndirectSend>> indirectSends;
+
+protected:
+
+	// Order of ambisonicBus, or 0 if sources are panned directly to the output layout
+	size_t ambisonicOrder;
+
+	// Bus sources are encoded into, if ambisonicOrder > 0
+	ABus ambisonicBus;
+
+	// Clear ambisonicBus for a block of `frames` frames. Returns false if Ambisonics is disabled.
+	bool beginAmbisonicBlock(size_t frames);
+
+	// Decode the block in ambisonicBus, constructively adding it to `bus`
+	void endAmbisonicBlock(ABus& bus, size_t frames);
+
+private:
+
+	// Order set by setAmbisonicOrder(), applied on next init()
+	size_t requestedAmbisonicOrder;
+
+	// Decoder to the layout of the last bus passed to endAmbisonicBlock()
+	AAmbisonicDecoder ambisonicDecoder;
 };
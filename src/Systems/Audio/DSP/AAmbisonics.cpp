@@ -0,0 +1,151 @@
+#include "AAmbisonics.h"
+#include "ASIMD.h"
+#include <algorithm>
+#include <cmath>
+
+// Number of horizontal directions the decoder gain is normalized over
+constexpr size_t decoderNormalizationDirections = 360;
+
+// Evenly spaced virtual speakers decoded to before panning to the real layout. Enough for a regular
+// decoder up to the maximum order.
+constexpr size_t virtualSpeakerCount = 24;
+
+namespace
+{
+	// Legendre polynomial P_n(x) for n <= 3
+	float legendre(size_t n, float x)
+	{
+		switch (n) {
+		case 0: return 1.f;
+		case 1: return x;
+		case 2: return 0.5f * (3.f * x * x - 1.f);
+		default: return 0.5f * (5.f * x * x * x - 3.f * x);
+		}
+	}
+
+	// World space direction of a speaker at `azimuth` on the horizontal plane
+	mat::vec3 speakerDirection(float azimuth)
+	{
+		return mat::vec3{ sinf(azimuth), 0.f, cosf(azimuth) };
+	}
+}
+
+void ambisonics::encode(size_t order, const mat::vec3& direction, float* gains)
+{
+	order = std::min(order, maxOrder);
+	std::fill_n(gains, channelCount(order), 0.f);
+	gains[0] = 1.f;
+
+	float length = sqrtf(mat::dot(direction, direction));
+	if (length == 0.f || order == 0) return;
+
+	// Ambisonic axes: x to the front (+Z), y to the left (-X), z up (+Y)
+	const float x = direction.z / length;
+	const float y = -direction.x / length;
+	const float z = direction.y / length;
+
+	gains[1] = y;
+	gains[2] = z;
+	gains[3] = x;
+	if (order == 1) return;
+
+	const float sqrt3 = sqrtf(3.f);
+	gains[4] = sqrt3 * x * y;
+	gains[5] = sqrt3 * y * z;
+	gains[6] = 0.5f * (3.f * z * z - 1.f);
+	gains[7] = sqrt3 * x * z;
+	gains[8] = 0.5f * sqrt3 * (x * x - y * y);
+	if (order == 2) return;
+
+	const float sqrt5_8 = sqrtf(5.f / 8.f);
+	const float sqrt3_8 = sqrtf(3.f / 8.f);
+	const float sqrt15 = sqrtf(15.f);
+	gains[9] = sqrt5_8 * y * (3.f * x * x - y * y);
+	gains[10] = sqrt15 * x * y * z;
+	gains[11] = sqrt3_8 * y * (5.f * z * z - 1.f);
+	gains[12] = 0.5f * z * (5.f * z * z - 3.f);
+	gains[13] = sqrt3_8 * x * (5.f * z * z - 1.f);
+	gains[14] = 0.5f * sqrt15 * z * (x * x - y * y);
+	gains[15] = sqrt5_8 * x * (x * x - 3.f * y * y);
+}
+
+AAmbisonicDecoder::AAmbisonicDecoder() :
+	order(0),
+	speakers{},
+	speakerCount(0),
+	matrix{}
+{
+}
+
+void AAmbisonicDecoder::init(size_t order, const ABusLayout& layout)
+{
+	this->order = std::min(order, ambisonics::maxOrder);
+	speakerCount = std::min(layout.channels.size(), ABusLayout::maxChannels);
+	std::copy_n(layout.channels.begin(), speakerCount, speakers.begin());
+	matrix.fill(0.f);
+
+	const size_t channels = ambisonics::channelCount(this->order);
+
+	// max-rE weights reduce the side lobes of the sampling decoder
+	float weights[ambisonics::maxOrder + 1];
+	const float rE = cosf(137.9f * mat::pi / 180.f / (static_cast<float>(this->order) + 1.51f));
+	for (size_t n = 0; n <= this->order; n++) weights[n] = legendre(n, rE) * static_cast<float>(2 * n + 1);
+
+	// All-round decoding: with SN3D encoding, the sum over one order of Y(a) * Y(b) is P_n(cos(angle
+	// between a and b)), so weighting harmonics by order gives a max-rE sampling decoder to a ring of
+	// virtual speakers. Each virtual speaker is then panned to the real layout, which keeps the decoder
+	// well behaved on sparse and irregular layouts.
+	float harmonics[ambisonics::channelCount(ambisonics::maxOrder)];
+	float panGains[ABusLayout::maxChannels];
+	for (size_t v = 0; v < virtualSpeakerCount; v++) {
+		float azimuth = 2.f * mat::pi * static_cast<float>(v) / static_cast<float>(virtualSpeakerCount);
+		ambisonics::encode(this->order, speakerDirection(azimuth), harmonics);
+		layout.pan(azimuth, panGains);
+		for (size_t s = 0; s < speakerCount; s++) {
+			if (panGains[s] == 0.f) continue;
+			for (size_t n = 0; n <= this->order; n++) {
+				for (size_t k = n * n; k < (n + 1) * (n + 1); k++) {
+					matrix[s * channels + k] += panGains[s] * weights[n] * harmonics[k];
+				}
+			}
+		}
+	}
+
+	// normalize to unit average energy for sources on the horizontal plane
+	double energy = 0.0;
+	for (size_t i = 0; i < decoderNormalizationDirections; i++) {
+		float azimuth = 2.f * mat::pi * static_cast<float>(i) / static_cast<float>(decoderNormalizationDirections);
+		ambisonics::encode(this->order, speakerDirection(azimuth), harmonics);
+		for (size_t s = 0; s < speakerCount; s++) {
+			float gain = 0.f;
+			for (size_t k = 0; k < channels; k++) gain += matrix[s * channels + k] * harmonics[k];
+			energy += gain * gain;
+		}
+	}
+	energy /= decoderNormalizationDirections;
+	if (energy > 0.0) {
+		const float scale = static_cast<float>(1.0 / std::sqrt(energy));
+		for (auto& gain : matrix) gain *= scale;
+	}
+}
+
+bool AAmbisonicDecoder::matches(size_t order, const ABusLayout& layout) const
+{
+	if (std::min(order, ambisonics::maxOrder) != this->order || layout.channels.size() != speakerCount) return false;
+	for (size_t s = 0; s < speakerCount; s++) {
+		if (layout.channels[s].azimuth != speakers[s].azimuth || layout.channels[s].bLFE != speakers[s].bLFE) return false;
+	}
+	return true;
+}
+
+void AAmbisonicDecoder::decode(const ABus& in, ABus& out, size_t frames) const
+{
+	const size_t channels = ambisonics::channelCount(order);
+	const size_t outputs = std::min(speakerCount, out.channelCount());
+	for (size_t s = 0; s < outputs; s++) {
+		for (size_t k = 0; k < channels; k++) {
+			float gain = matrix[s * channels + k];
+			if (gain != 0.f) simd::gainAccumulate(out.channel(s), in.channel(k), gain, 0.f, frames);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "ABus.h"
+#include "../../../Util/Matrix.h"
+#include <array>
+
+// Higher-order Ambisonics in ACN channel order with SN3D normalization
+namespace ambisonics
+{
+	// Highest supported order
+	constexpr size_t maxOrder = 3;
+
+	// Number of Ambisonic channels of order `order`
+	constexpr size_t channelCount(size_t order) { return (order + 1) * (order + 1); }
+
+	// Spherical harmonic gains encoding a source in world space direction `direction`, which need not
+	// be normalized. Writes channelCount(order) gains. A zero direction is encoded omnidirectionally.
+	void encode(size_t order, const mat::vec3& direction, float* gains);
+}
+
+// AAmbisonicDecoder renders an Ambisonic bus to a speaker layout. It decodes to a regular ring of virtual
+// speakers with max-rE weights, and pans those to the layout's speakers. The decode matrix is stored
+// inline, so the decoder can be set up on the audio thread without allocating.
+class AAmbisonicDecoder
+{
+public:
+
+	AAmbisonicDecoder();
+
+	// Compute the decode matrix from Ambisonic order `order` to `layout`
+	void init(size_t order, const ABusLayout& layout);
+
+	// Returns true if init() was last called with `order` and an identical layout
+	bool matches(size_t order, const ABusLayout& layout) const;
+
+	// Decode `frames` frames of the Ambisonic bus `in`, constructively adding to the speaker bus `out`
+	void decode(const ABus& in, ABus& out, size_t frames) const;
+
+private:
+
+	size_t order;
+
+	// Speaker azimuths and LFE flags the matrix was computed for
+	std::array<ABusLayout::Channel, ABusLayout::maxChannels> speakers;
+
+	size_t speakerCount;
+
+	// Gain of each Ambisonic channel for each speaker, row-major by speaker
+	std::array<float, ABusLayout::maxChannels * ambisonics::channelCount(ambisonics::maxOrder)> matrix;
+};
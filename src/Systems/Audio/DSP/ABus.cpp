@@ -0,0 +1,181 @@
+#include "ABus.h"
+#include "../../../Util/Matrix.h"
+#include <algorithm>
+#include <cmath>
+
+ABusLayout ABusLayout::mono()
+{
+	return forChannelCount(1);
+}
+
+ABusLayout ABusLayout::stereo()
+{
+	return forChannelCount(2);
+}
+
+ABusLayout ABusLayout::surround51()
+{
+	return forChannelCount(6);
+}
+
+ABusLayout ABusLayout::surround71()
+{
+	return forChannelCount(8);
+}
+
+ABusLayout ABusLayout::ring(size_t n)
+{
+	ABusLayout layout;
+	for (size_t i = 0; i < n; i++) {
+		layout.channels.push_back({ 2.f * mat::pi * static_cast<float>(i) / static_cast<float>(n), false });
+	}
+	layout.sortPanOrder();
+	return layout;
+}
+
+ABusLayout ABusLayout::forChannelCount(size_t n)
+{
+	const float deg = mat::pi / 180.f;
+
+	ABusLayout layout;
+	switch (n) {
+	case 1:
+		layout.channels = { { 0.f, false } };
+		break;
+	case 2:
+		layout.channels = { { -30.f * deg, false }, { 30.f * deg, false } };
+		break;
+	case 6:
+		// L, R, C, LFE, Ls, Rs
+		layout.channels = {
+			{ -30.f * deg, false }, { 30.f * deg, false }, { 0.f, false }, { 0.f, true },
+			{ -110.f * deg, false }, { 110.f * deg, false } };
+		break;
+	case 8:
+		// L, R, C, LFE, Lb, Rb, Ls, Rs
+		layout.channels = {
+			{ -30.f * deg, false }, { 30.f * deg, false }, { 0.f, false }, { 0.f, true },
+			{ -150.f * deg, false }, { 150.f * deg, false }, { -90.f * deg, false }, { 90.f * deg, false } };
+		break;
+	default:
+		return ring(n);
+	}
+	layout.sortPanOrder();
+	return layout;
+}
+
+void ABusLayout::sortPanOrder()
+{
+	panOrder.clear();
+	for (size_t i = 0; i < channels.size(); i++) {
+		if (!channels[i].bLFE) panOrder.push_back(i);
+	}
+
+	// sort by azimuth in [0, 2pi)
+	auto wrapped = [this](size_t i) {
+		float a = std::fmod(channels[i].azimuth, 2.f * mat::pi);
+		return a < 0.f ? a + 2.f * mat::pi : a;
+	};
+	std::sort(panOrder.begin(), panOrder.end(), [&](size_t a, size_t b) { return wrapped(a) < wrapped(b); });
+}
+
+void ABusLayout::pan(float azimuth, float* gains) const
+{
+	std::fill_n(gains, channels.size(), 0.f);
+	if (panOrder.empty()) return;
+	if (panOrder.size() == 1) {
+		gains[panOrder[0]] = 1.f;
+		return;
+	}
+
+	auto wrap = [](float a) {
+		a = std::fmod(a, 2.f * mat::pi);
+		return a < 0.f ? a + 2.f * mat::pi : a;
+	};
+	azimuth = wrap(azimuth);
+
+	// find the pair of neighbouring speakers enclosing the azimuth, which wraps around behind the last speaker
+	for (size_t k = 0; k < panOrder.size(); k++) {
+		size_t a = panOrder[k];
+		size_t b = panOrder[(k + 1) % panOrder.size()];
+		float start = wrap(channels[a].azimuth);
+		float width = wrap(channels[b].azimuth - start);
+		if (width == 0.f) width = 2.f * mat::pi;
+		float offset = wrap(azimuth - start);
+		if (offset <= width) {
+			float angle = 0.5f * mat::pi * offset / width;
+			gains[a] = cosf(angle);
+			gains[b] = sinf(angle);
+			return;
+		}
+	}
+}
+
+ABus::ABus() :
+	frameCapacity(0)
+{
+}
+
+void ABus::init(const ABusLayout& layout, size_t maxFrames)
+{
+	busLayout = layout;
+	frameCapacity = maxFrames;
+	samples.clear();
+	samples.resize(layout.channels.size() * maxFrames);
+}
+
+void ABus::init(size_t channels, size_t maxFrames)
+{
+	ABusLayout layout;
+	layout.channels.resize(channels, { 0.f, false });
+	init(layout, maxFrames);
+}
+
+void ABus::clear(size_t frames)
+{
+	for (size_t ch = 0; ch < channelCount(); ch++) std::fill_n(channel(ch), frames, 0.f);
+}
+
+void ABus::interleave(float* out, size_t frames) const
+{
+	const size_t channels = channelCount();
+	if (channels == 2) {
+		const float* l = channel(0);
+		const float* r = channel(1);
+		for (size_t i = 0; i < frames; i++) {
+			out[2 * i] = l[i];
+			out[2 * i + 1] = r[i];
+		}
+		return;
+	}
+
+	for (size_t ch = 0; ch < channels; ch++) {
+		const float* in = channel(ch);
+		for (size_t i = 0; i < frames; i++) out[i * channels + ch] = in[i];
+	}
+}
+
+float* ABus::channel(size_t ch)
+{
+	return samples.data() + ch * frameCapacity;
+}
+
+const float* ABus::channel(size_t ch) const
+{
+	return samples.data() + ch * frameCapacity;
+}
+
+size_t ABus::channelCount() const
+{
+	return busLayout.channels.size();
+}
+
+size_t ABus::maxFrames() const
+{
+	return frameCapacity;
+}
+
+const ABusLayout& ABus::layout() const
+{
+	return busLayout;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+// Speaker arrangement of an ABus
+struct ABusLayout
+{
+	// Largest supported number of channels
+	static constexpr size_t maxChannels = 32;
+
+	struct Channel
+	{
+		// Horizontal direction of the speaker in radians, clockwise from +Z (front) towards +X (right)
+		float azimuth;
+
+		// Low frequency effects channel, which is not panned to
+		bool bLFE;
+	};
+
+	// Channels in output order
+	std::vector<Channel> channels;
+
+	// Indices of the non-LFE channels, sorted by azimuth
+	std::vector<size_t> panOrder;
+
+	// Standard layouts, in WAVE channel order
+	static ABusLayout mono();
+	static ABusLayout stereo();
+	static ABusLayout surround51();
+	static ABusLayout surround71();
+
+	// `n` speakers evenly spaced around the listener, starting at the front
+	static ABusLayout ring(size_t n);
+
+	// The standard layout with `n` channels if one exists, otherwise a ring of `n` speakers
+	static ABusLayout forChannelCount(size_t n);
+
+	// Constant power pan between the two speakers adjacent to `azimuth`. Writes one gain per channel to `gains`.
+	void pan(float azimuth, float* gains) const;
+
+private:
+
+	// Fill panOrder from channels
+	void sortPanOrder();
+};
+
+// ABus is a planar block of audio with one contiguous buffer per output channel. Output components
+// mix into the bus, which is interleaved into the device buffer once at the end of each callback.
+class ABus
+{
+public:
+
+	// Largest block a bus holds. The engine processes longer callbacks in several blocks, which are
+	// shorter still at sample rates where a delay line holds fewer samples.
+	static constexpr size_t maxBlockFrames = 4096;
+
+	ABus();
+
+	// Allocate storage for up to `maxFrames` frames of each channel of `layout`
+	void init(const ABusLayout& layout, size_t maxFrames);
+
+	// Allocate storage for `channels` channels that do not feed speakers, such as Ambisonic signals
+	void init(size_t channels, size_t maxFrames);
+
+	// Set the first `frames` frames of every channel to zero
+	void clear(size_t frames);
+
+	// Write the first `frames` frames of every channel to the interleaved buffer `out`
+	void interleave(float* out, size_t frames) const;
+
+	// Samples of channel `ch`
+	float* channel(size_t ch);
+	const float* channel(size_t ch) const;
+
+	size_t channelCount() const;
+
+	// Number of frames each channel can hold
+	size_t maxFrames() const;
+
+	const ABusLayout& layout() const;
+
+private:
+
+	ABusLayout busLayout;
+
+	// Channel buffers, one after another
+	std::vector<float> samples;
+
+	size_t frameCapacity;
+};
@@ -1,20 +1,91 @@
 #include "AConvolver.h"
-#include "../AWAVFile.h"
+#include "AFFTPlanner.h"
+#include "ASIMD.h"
+#include "../AudioProfiler.h"
+#include "../AudioWorkerPool.h"
+#include "../../../Util/ThreadPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+// Default partition size of the head stage, which determines the convolver latency
+constexpr size_t defaultMinBlockSize = 128;
+
+// Default partition size of the tail stage
+constexpr size_t defaultMaxBlockSize = 8192;
+
+// Stages of at least this many head blocks are processed on background workers. Smaller stages are
+// cheap enough that handing them over would cost more than it saves.
+constexpr size_t backgroundBlockFactor = 8;
+
+namespace
+{
+	// Prepares and frees the IRs of all convolvers in the order they were requested
+	ThreadPool& backgroundThread()
+	{
+		static ThreadPool thread(1);
+		return thread;
+	}
 
-// IR partition block size
-constexpr size_t blockSize = 256;
-constexpr size_t N = blockSize * 2;
+	size_t nextPowerOfTwo(size_t n)
+	{
+		size_t p = 1;
+		while (p < n) p <<= 1;
+		return p;
+	}
+}
 
-AConvolver::AConvolver() :
-	partitions(0),
-	inputBuffer(nullptr),
-	fftResult(nullptr),
+AConvolver::TailJob::TailJob() :
+	state(State::Idle),
+	queued(0),
+	stage(nullptr),
+	freqDelayLine(nullptr),
+	fdlPtr(0),
 	ifftInput(nullptr),
 	outputBuffer(nullptr),
-	inputPtr(0),
-	fdlPtr(0),
-	fftPlan(nullptr),
-	ifftPlan(nullptr)
+	bLaunched(false),
+	launchFreqDelayLine(nullptr),
+	launchFdlPtr(0)
+{
+}
+
+AConvolver::Kernel::~Kernel()
+{
+	for (Stage& stage : stages) {
+		// a worker may still hold a submission of a job the audio thread already took over
+		if (stage.job) {
+			while (stage.job->queued.load(std::memory_order_acquire) != 0) std::this_thread::yield();
+			if (stage.job->ifftInput) fftwf_free(stage.job->ifftInput);
+			if (stage.job->outputBuffer) fftwf_free(stage.job->outputBuffer);
+		}
+		if (stage.freqDelayLine) fftwf_free(stage.freqDelayLine);
+		if (stage.inputBuffer) fftwf_free(stage.inputBuffer);
+		if (stage.ifftInput) fftwf_free(stage.ifftInput);
+		if (stage.outputBuffer) fftwf_free(stage.outputBuffer);
+	}
+}
+
+AConvolver::KernelExchange::KernelExchange() :
+	pending(nullptr),
+	latestRequest(0),
+	changedBegin(SIZE_MAX),
+	changedEnd(0)
+{
+}
+
+AConvolver::KernelExchange::~KernelExchange()
+{
+	delete pending.load();
+}
+
+AConvolver::AConvolver() :
+	minBlockSize(defaultMinBlockSize),
+	maxBlockSize(defaultMaxBlockSize),
+	headBlockSize(defaultMinBlockSize),
+	tailBlockSize(defaultMaxBlockSize),
+	bBackgroundProcessing(true),
+	backgroundBlockSize(SIZE_MAX),
+	samplePtr(0)
 {
 	bAcceptsInput = true;
 	bCanProcessInPlace = true;
@@ -27,28 +98,50 @@ AConvolver::AConvolver(std::string impulseResponseFilepath) : AConvolver()
 
 void AConvolver::setIR(const std::vector<float>& newIR)
 {
-	impulseResponse = newIR;
-	size_t blocks = impulseResponse.size() / blockSize;
-	if (impulseResponse.size() % blockSize) blocks++;
-	impulseResponse.resize(blocks * blockSize); // zero pad last block
-
-	if (bInitialized) loadIR();
+	impulseResponseSamples = newIR;
+	impulseResponseFilepath.clear();
+	if (bInitialized) requestIR();
 }
 
 void AConvolver::setIR(std::string filepath)
 {
-	AWAVFile wav(filepath);
-	if (wav.data.empty() || wav.channels != 1) {
-		fprintf(stderr, "Incompatible wav file.\n");
+	impulseResponseSamples.clear();
+	impulseResponseFilepath = filepath;
+	if (bInitialized) requestIR();
+}
+
+void AConvolver::updateIR(size_t offset, const float* samples, size_t count)
+{
+	if (!impulseResponseFilepath.empty()) {
+		fprintf(stderr, "Partial IR updates require an IR set from samples.\n");
+		return;
 	}
-	else {
-		setIR(wav.data);
+
+	if (offset + count > impulseResponseSamples.size()) impulseResponseSamples.resize(offset + count, 0.f);
+	std::copy_n(samples, count, impulseResponseSamples.data() + offset);
+	if (bInitialized) requestIR(offset, offset + count);
+}
+
+void AConvolver::setPartitionSizes(size_t minBlockSize, size_t maxBlockSize)
+{
+	if (minBlockSize == 0) {
+		fprintf(stderr, "Convolver partition sizes must be greater than zero.\n");
+		return;
 	}
+
+	this->minBlockSize = nextPowerOfTwo(minBlockSize);
+	this->maxBlockSize = std::max(this->minBlockSize, nextPowerOfTwo(maxBlockSize));
+}
+
+void AConvolver::setBackgroundProcessing(bool bEnabled)
+{
+	bBackgroundProcessing = bEnabled;
 }
 
 void AConvolver::init(float sampleRate)
 {
 	ADSPBase::init(sampleRate);
+	processTimer = AudioProfiler::instance().createTimer("AConvolver", this);
 	loadIR();
 }
 
@@ -56,139 +149,468 @@ void AConvolver::deinit()
 {
 	ADSPBase::deinit();
 	unloadIR();
+	processTimer.reset();
 }
 
 void AConvolver::loadIR()
 {
 	unloadIR();
 
-	partitions = impulseResponse.size() / blockSize;
-	if (!partitions) return;
+	headBlockSize = minBlockSize;
+	tailBlockSize = maxBlockSize;
+	exchange = std::make_shared<KernelExchange>();
 
-	impulseResponseFFTs.reserve(partitions);
-	freqDelayLine.reserve(partitions);
+	// The background workers, which also free replaced kernels, are spawned here rather than on the
+	// audio thread
+	AudioBackgroundPool::instance();
+	backgroundBlockSize = bBackgroundProcessing ? headBlockSize * backgroundBlockFactor : SIZE_MAX;
 
-	float* fftIn = fftwf_alloc_real(N);
-	complex* fftOut = reinterpret_cast<complex*>(fftwf_alloc_complex(N));
-	if (!convassert(fftIn && fftOut)) return;
-	fftwf_plan p = fftwf_plan_dft_r2c_1d(N, fftIn, reinterpret_cast<fftwf_complex*>(fftOut), FFTW_ESTIMATE);
-	std::fill_n(fftIn + blockSize, blockSize, 0.f); // zero pad input
+	// Both rings span two of the largest possible stage blocks, so every stage's FFT window is
+	// available whichever IR is swapped in later
+	inputHistory.resize(tailBlockSize * 2, 0.f);
+	outputAccumulator.resize(tailBlockSize * 2, 0.f);
+	samplePtr = 0;
 
-	for (size_t i = 0; i < partitions; i++) {
-		std::copy_n(impulseResponse.data() + blockSize * i, blockSize, fftIn);
-		fftwf_execute(p);
+	if (impulseResponseFilepath.empty() && impulseResponseSamples.empty()) return;
 
-		// save IR FFT partition
-		complex* arr = reinterpret_cast<complex*>(fftwf_alloc_complex(blockSize + 1));
-		if (!convassert(arr)) return;
-		std::copy_n(&fftOut[0], blockSize + 1, &arr[0]);
-		impulseResponseFFTs.push_back(arr);
+	auto impulseResponse = acquireIR(impulseResponseFilepath, impulseResponseSamples, sampleRate, headBlockSize, tailBlockSize);
+	if (!impulseResponse || impulseResponse->segments.empty()) return;
+
+	kernel = createKernel(impulseResponse, backgroundBlockSize);
+	exchange->latestIR = impulseResponse;
+	convassert(kernel != nullptr);
+}
+
+void AConvolver::unloadIR()
+{
+	// A background request still holding the exchange frees its result along with it. Jobs of the
+	// previous kernel may read FDLs handed over to the current kernel, so it goes first.
+	previousKernel.reset();
+	kernel.reset();
+	exchange.reset();
+	inputHistory.clear();
+	outputAccumulator.clear();
+	samplePtr = 0;
+}
 
-		// push input FDL buffer
-		complex* fdlBuffer = reinterpret_cast<complex*>(fftwf_alloc_complex(blockSize + 1));
-		if (!convassert(fdlBuffer)) return;
-		std::fill_n(&fdlBuffer[0], blockSize + 1, 0.f);
-		freqDelayLine.push_back(fdlBuffer);
+void AConvolver::waitForPendingIRs()
+{
+	backgroundThread().waitForTasks();
+}
+
+void AConvolver::requestIR(size_t changedBegin, size_t changedEnd)
+{
+	uint64_t request;
+	{
+		std::lock_guard<std::mutex> lock(exchange->mutex);
+		exchange->changedBegin = std::min(exchange->changedBegin, changedBegin);
+		exchange->changedEnd = std::max(exchange->changedEnd, changedEnd);
+		request = exchange->latestRequest.fetch_add(1) + 1;
 	}
 
-	fftwf_destroy_plan(p);
-	fftwf_free(fftIn);
-	fftwf_free(fftOut);
+	backgroundThread().enqueue([
+		exchange = exchange,
+		request,
+		filepath = impulseResponseFilepath,
+		samples = impulseResponseSamples,
+		sampleRate = sampleRate,
+		minBlockSize = headBlockSize,
+		maxBlockSize = tailBlockSize,
+		backgroundBlockSize = backgroundBlockSize]
+	{
+		// Only the newest IR matters if requests come in faster than they are prepared. The changes
+		// of skipped requests remain in the changed range.
+		size_t changedBegin, changedEnd;
+		{
+			std::lock_guard<std::mutex> lock(exchange->mutex);
+			if (request != exchange->latestRequest.load()) return;
+			changedBegin = exchange->changedBegin;
+			changedEnd = exchange->changedEnd;
+			exchange->changedBegin = SIZE_MAX;
+			exchange->changedEnd = 0;
+		}
 
-	// Input buffer filled from process() input
-	inputBuffer = fftwf_alloc_real(N);
-	if (!convassert(inputBuffer)) return;
+		// transform only what changed if the partition layout stays the same
+		std::shared_ptr<const AImpulseResponse> impulseResponse;
+		const auto& base = exchange->latestIR;
+		if (filepath.empty() && base && !base->segments.empty() && base->length == samples.size()) {
+			impulseResponse = std::make_shared<const AImpulseResponse>(*base, samples, changedBegin, changedEnd);
+		}
+		else {
+			impulseResponse = acquireIR(filepath, samples, sampleRate, minBlockSize, maxBlockSize);
+		}
+		if (!impulseResponse) return;
+		exchange->latestIR = impulseResponse;
 
-	// Result of the real to complex FFT on the input stream
-	fftResult = reinterpret_cast<complex*>(fftwf_alloc_complex(N));
-	if (!convassert(fftResult)) return;
+		auto newKernel = createKernel(impulseResponse, backgroundBlockSize);
+		if (!newKernel) return;
 
-	// Result and final output of the IFFT
-	outputBuffer = fftwf_alloc_real(N);
-	if (!convassert(outputBuffer)) return;
+		// replace a prepared kernel that process() has not picked up yet
+		delete exchange->pending.exchange(newKernel.release(), std::memory_order_acq_rel);
+	});
+}
 
-	// Input to the IFFT
-	ifftInput = reinterpret_cast<complex*>(fftwf_alloc_complex(N));
-	if (!convassert(ifftInput)) return;
+std::shared_ptr<const AImpulseResponse> AConvolver::acquireIR(
+	const std::string& filepath,
+	const std::vector<float>& samples,
+	float sampleRate,
+	size_t minBlockSize,
+	size_t maxBlockSize)
+{
+	auto& cache = AImpulseResponseCache::instance();
+	if (!filepath.empty()) return cache.acquire(filepath, sampleRate, minBlockSize, maxBlockSize);
+	return cache.acquire(samples, sampleRate, minBlockSize, maxBlockSize);
+}
+
+std::unique_ptr<AConvolver::Kernel> AConvolver::createKernel(std::shared_ptr<const AImpulseResponse> impulseResponse, size_t backgroundBlockSize)
+{
+	auto newKernel = std::make_unique<Kernel>();
+	newKernel->impulseResponse = impulseResponse;
+	newKernel->stages.reserve(impulseResponse->segments.size());
+
+	for (const auto& segment : impulseResponse->segments) {
+		Stage& stage = newKernel->stages.emplace_back();
+		if (!loadStage(stage, segment, backgroundBlockSize)) return nullptr;
+	}
+	return newKernel;
+}
 
-	fftPlan = fftwf_plan_dft_r2c_1d(
-		N,
-		inputBuffer,
-		reinterpret_cast<fftwf_complex*>(fftResult),
-		FFTW_MEASURE | FFTW_PRESERVE_INPUT);
+bool AConvolver::loadStage(Stage& stage, const AImpulseResponse::Segment& segment, size_t backgroundBlockSize)
+{
+	const size_t N = segment.blockSize * 2;
+	stage = {};
+	stage.segment = &segment;
+	stage.fdlSize = segment.delay + segment.partitions;
+	stage.fdlPtr = 0;
 
-	ifftPlan = fftwf_plan_dft_c2r_1d(
-		N,
-		reinterpret_cast<fftwf_complex*>(ifftInput),
-		outputBuffer,
-		FFTW_MEASURE | FFTW_DESTROY_INPUT);
+	// Input buffer filled from the input history
+	stage.inputBuffer = fftwf_alloc_real(N);
+	if (!stage.inputBuffer) return false;
 
-	std::fill_n(inputBuffer, blockSize, 0.f);
-	std::fill_n(outputBuffer + blockSize, blockSize, 0.f);
+	// Input to the IFFT
+	stage.ifftInput = fftwf_alloc_real(segment.stride * 2);
+	if (!stage.ifftInput) return false;
+
+	// Result of the IFFT
+	stage.outputBuffer = fftwf_alloc_real(N);
+	if (!stage.outputBuffer) return false;
+
+	// The FDL holds the delayed input spectra preceding this stage's segment, followed by one per partition
+	stage.freqDelayLine = fftwf_alloc_real(segment.stride * 2 * stage.fdlSize);
+	if (!stage.freqDelayLine) return false;
+
+	// plans are shared by all convolvers, so this is only slow the first time a size is used
+	auto& planner = AFFTPlanner::instance();
+	stage.fftPlan = planner.forward(N);
+	stage.ifftPlan = planner.inverse(N);
+
+	if (!stage.fftPlan || !stage.ifftPlan) return false;
+
+	std::fill_n(stage.inputBuffer, N, 0.f);
+	std::fill_n(stage.freqDelayLine, segment.stride * 2 * stage.fdlSize, 0.f);
+
+	// A delayed stage's next output only depends on input it already has, so it can be computed during
+	// the block before it is due
+	if (segment.delay >= 1 && segment.blockSize >= backgroundBlockSize) {
+		stage.job = std::make_unique<TailJob>();
+		stage.job->stage = &stage;
+		stage.job->ifftInput = fftwf_alloc_real(segment.stride * 2);
+		stage.job->outputBuffer = fftwf_alloc_real(N);
+		if (!stage.job->ifftInput || !stage.job->outputBuffer) return false;
+	}
 
-	inputPtr = blockSize;
-	fdlPtr = 0;
+	return true;
 }
 
-void AConvolver::unloadIR()
+void AConvolver::swapKernel()
+{
+	// A kernel is retired once none of its spectra are needed anymore. Its jobs were submitted before,
+	// so the workers have taken them by the time it is freed. With the queue full, it is retried next block.
+	if (previousKernel) {
+		if (isFading()) return;
+		if (!AudioBackgroundPool::instance().submit(&deleteKernel, previousKernel.get())) return;
+		previousKernel.release();
+	}
+
+	Kernel* next = exchange->pending.exchange(nullptr, std::memory_order_acq_rel);
+	if (!next) return;
+
+	previousKernel = std::move(kernel);
+	kernel.reset(next);
+	if (!previousKernel) return;
+
+	// Stages of the same layout take over the old stage's input spectra and fade between the old and
+	// new IR. The rest start from silence, while the old stage fades out.
+	auto& stages = kernel->stages;
+	auto& oldStages = previousKernel->stages;
+	for (size_t i = 0; i < oldStages.size(); i++) {
+		Stage& oldStage = oldStages[i];
+		const auto* oldSegment = oldStage.segment;
+		if (i < stages.size() &&
+			stages[i].segment->blockSize == oldSegment->blockSize &&
+			stages[i].segment->delay == oldSegment->delay &&
+			stages[i].segment->partitions == oldSegment->partitions)
+		{
+			Stage& stage = stages[i];
+			std::swap(stage.freqDelayLine, oldStage.freqDelayLine);
+			stage.fdlPtr = oldStage.fdlPtr;
+
+			// segments untouched by an incremental update share their spectra, and need no fade
+			bool bChanged = stage.segment->spectra != oldSegment->spectra;
+			if (stage.job) {
+				// The old stage's job is already computing the next block from the same FDL. It is
+				// collected along with a job for the new spectra, or used as is if they are the same.
+				stage.replacedStage = &oldStage;
+				stage.bCrossfade = bChanged;
+				if (bChanged) launchJob(stage);
+			}
+			else if (bChanged) {
+				stage.replacedStage = &oldStage;
+				stage.bCrossfade = true;
+			}
+		}
+		else {
+			oldStage.bFadeOut = true;
+		}
+	}
+}
+
+bool AConvolver::isFading() const
 {
-	partitions = 0;
-	for (complex* c : impulseResponseFFTs) fftwf_free(reinterpret_cast<fftwf_complex*>(c));
-	for (complex* c : freqDelayLine) fftwf_free(reinterpret_cast<fftwf_complex*>(c));
-	if (inputBuffer) fftwf_free(inputBuffer);
-	if (fftResult) fftwf_free(fftResult);
-	if (ifftInput) fftwf_free(ifftInput);
-	if (outputBuffer) fftwf_free(outputBuffer);
-	if (fftPlan) fftwf_destroy_plan(fftPlan);
-	if (ifftPlan) fftwf_destroy_plan(ifftPlan);
-	impulseResponseFFTs.clear();
-	freqDelayLine.clear();
-	inputBuffer = nullptr;
-	fftResult = nullptr;
-	ifftInput = nullptr;
-	outputBuffer = nullptr;
-	fftPlan = nullptr;
-	ifftPlan = nullptr;
+	for (const Stage& stage : kernel->stages) {
+		if (stage.replacedStage) return true;
+	}
+	for (const Stage& stage : previousKernel->stages) {
+		if (stage.bFadeOut) return true;
+	}
+	return false;
 }
 
 void AConvolver::process(float* outbuffer, const float* inbuffer, size_t n)
 {
-	if (!partitions) {
+	AudioTimerScope timerScope(processTimer.get());
+
+	if (inputHistory.empty()) {
 		std::copy_n(inbuffer, n, outbuffer);
 		return;
 	}
 
-	for (size_t i = 0; i < n; i++) {
-		inputBuffer[inputPtr] = inbuffer[i];
-		outbuffer[i] = outputBuffer[inputPtr++] / N;
+	const size_t ringSize = inputHistory.size();
 
-		if (inputPtr == N) {
-			inputPtr = blockSize;
-			if (fftPlan) {
-				fftwf_execute(fftPlan);
+	size_t i = 0;
+	while (i < n) {
+		// IRs are only swapped on head block boundaries, where all new stages can start
+		if ((samplePtr & (headBlockSize - 1)) == 0) swapKernel();
 
-				complex* fdlBank = freqDelayLine[fdlPtr++];
-				std::copy_n(&fftResult[0], blockSize + 1, &fdlBank[0]);
-				if (fdlPtr == freqDelayLine.size()) fdlPtr = 0;
+		// Copy up to the next head block boundary. Every ring is a multiple of the head block
+		// size, so a span never wraps. Input is copied first, allowing in-place processing.
+		size_t count = std::min(n - i, headBlockSize - (samplePtr & (headBlockSize - 1)));
+		std::copy_n(inbuffer + i, count, inputHistory.data() + samplePtr);
+		if ((kernel && !kernel->stages.empty()) || previousKernel) {
+			std::copy_n(outputAccumulator.data() + samplePtr, count, outbuffer + i);
+			std::fill_n(outputAccumulator.data() + samplePtr, count, 0.f);
+		}
+		else {
+			// no IR, pass the input through
+			std::copy_n(inputHistory.data() + samplePtr, count, outbuffer + i);
+		}
+		i += count;
 
-				// pointwise multiply and add all FDL blocks
-				std::fill_n(&ifftInput[0], blockSize + 1, 0.f);
-				for (size_t p = 0; p < partitions; p++) {
-					size_t fdlIdx = (fdlPtr + p) % partitions;
-					size_t irIdx = partitions - p - 1;
-					for (size_t n = 0; n <= blockSize; n++) { // n < blockSize + 1
-						ifftInput[n] += freqDelayLine[fdlIdx][n] * impulseResponseFFTs[irIdx][n];
-					}
-				}
+		samplePtr += count;
+		if (samplePtr == ringSize) samplePtr = 0;
+		if (samplePtr & (headBlockSize - 1)) break; // input ran out before the boundary
 
-				// fill outputBuffer
-				fftwf_execute(ifftPlan);
+		// a stage runs each time a full block of its size has been received
+		if (kernel) {
+			for (Stage& stage : kernel->stages) {
+				if ((samplePtr & (stage.segment->blockSize - 1)) == 0) processStage(stage);
+			}
+		}
+		if (previousKernel) {
+			for (Stage& stage : previousKernel->stages) {
+				if (stage.bFadeOut && (samplePtr & (stage.segment->blockSize - 1)) == 0) processStage(stage);
+			}
+		}
+	}
+}
 
-				// shift input samples one block to the left
-				std::copy_n(inputBuffer + blockSize, blockSize, inputBuffer);
+void AConvolver::processStage(Stage& stage)
+{
+	const size_t blockSize = stage.segment->blockSize;
+
+	const float* output = stage.outputBuffer + blockSize;
+	const float* fadeOutput = nullptr;
+
+	if (stage.job) {
+		// this block's output has been computed in the background since the last boundary
+		output = collectJob(stage);
+		if (Stage* replacedStage = stage.replacedStage) {
+			const float* replacedOutput = collectJob(*replacedStage);
+			if (!stage.bCrossfade) {
+				output = replacedOutput;
+			}
+			else {
+				// a replaced stage that never launched a job has only received silence
+				if (!replacedOutput) {
+					std::fill_n(replacedStage->outputBuffer + blockSize, blockSize, 0.f);
+					replacedOutput = replacedStage->outputBuffer + blockSize;
+				}
+				fadeOutput = replacedOutput;
 			}
 		}
+
+		// a stage fading out has no further blocks to compute
+		if (!stage.bFadeOut) {
+			transformInput(stage);
+			if (++stage.fdlPtr == stage.fdlSize) stage.fdlPtr = 0;
+		}
 	}
+	else {
+		transformInput(stage);
+
+		// while fading, the input buffer is free to hold the output of the old spectra
+		if (stage.replacedStage) {
+			convolveStage(stage, *stage.replacedStage->segment, stage.freqDelayLine, stage.fdlPtr, stage.ifftInput, stage.outputBuffer);
+			std::copy_n(stage.outputBuffer + blockSize, blockSize, stage.inputBuffer);
+			fadeOutput = stage.inputBuffer;
+		}
+		convolveStage(stage, *stage.segment, stage.freqDelayLine, stage.fdlPtr, stage.ifftInput, stage.outputBuffer);
+		if (++stage.fdlPtr == stage.fdlSize) stage.fdlPtr = 0;
+	}
+
+	// The second half of the IFFT output is the stage's next output block. IR spectra are pre-scaled
+	// by the IFFT normalization, and the block starts on a boundary of its size, so it never wraps.
+	float* accumulator = outputAccumulator.data() + samplePtr;
+	const float fadeStep = 1.f / static_cast<float>(blockSize);
+	if (fadeOutput) {
+		for (size_t i = 0; i < blockSize; i++) {
+			accumulator[i] += fadeOutput[i] + (output[i] - fadeOutput[i]) * (static_cast<float>(i + 1) * fadeStep);
+		}
+	}
+	else if (output && stage.bFadeOut) {
+		for (size_t i = 0; i < blockSize; i++) accumulator[i] += output[i] * (1.f - static_cast<float>(i + 1) * fadeStep);
+	}
+	else if (output) {
+		for (size_t i = 0; i < blockSize; i++) accumulator[i] += output[i];
+	}
+
+	// the next job writes the output buffer again, so it is only launched once the output is used
+	if (stage.job && !stage.bFadeOut) launchJob(stage);
+	stage.replacedStage = nullptr;
+	stage.bFadeOut = false;
+}
+
+void AConvolver::transformInput(Stage& stage)
+{
+	const AImpulseResponse::Segment& segment = *stage.segment;
+	const size_t N = segment.blockSize * 2;
+	const size_t ringSize = inputHistory.size();
+
+	// copy the latest two blocks of input, which may wrap around the history ring
+	size_t start = (samplePtr + ringSize - N) % ringSize;
+	size_t nEnd = std::min(N, ringSize - start);
+	std::copy_n(inputHistory.data() + start, nEnd, stage.inputBuffer);
+	std::copy_n(inputHistory.data(), N - nEnd, stage.inputBuffer + nEnd);
+
+	// transform straight into the newest FDL slot
+	float* newest = segment.slot(stage.freqDelayLine, stage.fdlPtr);
+	fftwf_execute_split_dft_r2c(stage.fftPlan, stage.inputBuffer, newest, newest + segment.stride);
+}
+
+void AConvolver::convolveStage(const Stage& stage, const AImpulseResponse::Segment& spectra, const float* freqDelayLine, size_t fdlPtr, float* ifftInput, float* outputBuffer)
+{
+	const AImpulseResponse::Segment& segment = *stage.segment;
+	const size_t stride = segment.stride;
+
+	// pointwise multiply and add all FDL blocks, where FDL age `delay + p` pairs with partition `p`.
+	// Ages increase as slot indices decrease, wrapping from the first slot to the last.
+	float* accRe = ifftInput;
+	float* accIm = ifftInput + stride;
+	std::fill_n(ifftInput, stride * 2, 0.f);
+	size_t fdlIdx = fdlPtr >= segment.delay ? fdlPtr - segment.delay : fdlPtr + stage.fdlSize - segment.delay;
+	for (size_t p = 0; p < segment.partitions; p++) {
+		const float* fdl = segment.slot(freqDelayLine, fdlIdx);
+		const float* ir = spectra.slot(spectra.spectra, p);
+		simd::complexMultiplyAdd(accRe, accIm, fdl, fdl + stride, ir, ir + stride, segment.bins);
+		fdlIdx = fdlIdx ? fdlIdx - 1 : stage.fdlSize - 1;
+	}
+
+	fftwf_execute_split_dft_c2r(stage.ifftPlan, accRe, accIm, outputBuffer);
+}
+
+void AConvolver::launchJob(Stage& stage)
+{
+	TailJob& job = *stage.job;
+	job.bLaunched = true;
+	job.launchFreqDelayLine = stage.freqDelayLine;
+	job.launchFdlPtr = stage.fdlPtr;
+
+	// a late worker still owns the job's buffers, so collectJob() computes this block itself
+	if (job.state.load(std::memory_order_acquire) != TailJob::State::Idle) return;
+
+	job.freqDelayLine = stage.freqDelayLine;
+	job.fdlPtr = stage.fdlPtr;
+	job.state.store(TailJob::State::Queued, std::memory_order_release);
+
+	// with the queue full, the job stays queued until collectJob() runs it
+	job.queued.fetch_add(1, std::memory_order_relaxed);
+	if (!AudioBackgroundPool::instance().submit(&runJob, &job)) job.queued.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void AConvolver::deleteKernel(void* context)
+{
+	delete static_cast<Kernel*>(context);
+}
+
+void AConvolver::runJob(void* context)
+{
+	TailJob& job = *static_cast<TailJob*>(context);
+
+	auto expected = TailJob::State::Queued;
+	if (job.state.compare_exchange_strong(expected, TailJob::State::Running, std::memory_order_acquire)) {
+		convolveStage(*job.stage, *job.stage->segment, job.freqDelayLine, job.fdlPtr, job.ifftInput, job.outputBuffer);
+
+		// if the audio thread gave up on this block, the result is dropped and the job freed for the next
+		expected = TailJob::State::Running;
+		if (!job.state.compare_exchange_strong(expected, TailJob::State::Done, std::memory_order_release)) {
+			job.state.store(TailJob::State::Idle, std::memory_order_release);
+		}
+	}
+
+	// last access, as the kernel may be freed as soon as no submission is left
+	job.queued.fetch_sub(1, std::memory_order_release);
+}
+
+const float* AConvolver::collectJob(Stage& stage)
+{
+	TailJob& job = *stage.job;
+	if (!job.bLaunched) return nullptr;
+	job.bLaunched = false;
+
+	const size_t blockSize = stage.segment->blockSize;
+	auto state = job.state.load(std::memory_order_acquire);
+	if (state == TailJob::State::Done) {
+		job.state.store(TailJob::State::Idle, std::memory_order_relaxed);
+		return job.outputBuffer + blockSize;
+	}
+
+	// Take the job back from the queue, or leave a running worker to finish into its own buffers
+	// while its result is discarded. Waiting for it would stall the audio thread on a worker thread.
+	// A failed exchange updates `state`, as a worker may have claimed or finished the job meanwhile.
+	if (state == TailJob::State::Queued) {
+		job.state.compare_exchange_strong(state, TailJob::State::Idle, std::memory_order_acquire);
+	}
+	if (state == TailJob::State::Running) {
+		job.state.compare_exchange_strong(state, TailJob::State::Late, std::memory_order_acquire);
+	}
+	if (state == TailJob::State::Done) {
+		job.state.store(TailJob::State::Idle, std::memory_order_relaxed);
+		return job.outputBuffer + blockSize;
+	}
+
+	AudioProfiler::instance().recordBackgroundDeadlineMiss();
+	convolveStage(stage, *stage.segment, job.launchFreqDelayLine, job.launchFdlPtr, stage.ifftInput, stage.outputBuffer);
+	return stage.outputBuffer + blockSize;
 }
 
 bool AConvolver::convassert(bool condition)
@@ -1,11 +1,29 @@
 #pragma once
 
 #include "ADSPBase.h"
+#include "AImpulseResponse.h"
 #include <fftw3.h>
 #include <string>
 #include <vector>
-#include <complex>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
 
+// AConvolver implements non-uniform partitioned overlap-save convolution. The head of the
+// impulse response is split into small partitions for low latency, and each following stage
+// doubles the partition size up to a maximum, which keeps the cost of long IRs low.
+//
+// The IR may be changed while the convolver is in use. A new IR is partitioned, transformed and
+// allocated on a background thread, then picked up by process() with an atomic swap. Each stage
+// crossfades from the old to the new spectra over its next block, and the replaced IR is handed to
+// a background worker to be freed once the fades complete, so the audio thread never allocates,
+// frees or plans.
+//
+// Long tail stages are only due once per large block, yet their multiply-adds would all land in the
+// callback that completes the block. Stages that are delayed by at least one of their blocks don't
+// need the newest input, so their multiply-adds and IFFT run on the shared AudioBackgroundPool over
+// the course of the preceding block, leaving only the input FFT and accumulation to the callback.
 class AConvolver final : public ADSPBase
 {
 public:
@@ -14,11 +32,31 @@ public:
 	AConvolver(std::string impulseResponseFilepath);
 
 	// Set the impulse response of the convolver. Sample rate is assumed to be that of the session.
+	// If initialized, the IR is prepared in the background and swapped in by a later process().
 	void setIR(const std::vector<float>& newIR);
 
 	// Set the impulse response of the convolver from a filepath
 	void setIR(std::string filepath);
 
+	// Replace `count` samples of the IR set by setIR(samples), starting at `offset`. If initialized,
+	// only the partitions overlapping the changed range are transformed again, so the cost of the
+	// update scales with the size of the change rather than the length of the IR.
+	void updateIR(size_t offset, const float* samples, size_t count);
+
+	// Set the smallest (head) and largest (tail) partition sizes. Stages are triggered by masking the
+	// sample position and each doubles the size of the last, so sizes are rounded up to powers of two,
+	// and a smallest size of zero is rejected. The smallest size is the latency of the convolver. Equal
+	// sizes result in uniform partitioning. Applied on next init().
+	void setPartitionSizes(size_t minBlockSize, size_t maxBlockSize);
+
+	// Process long tail stages on background worker threads (default), or entirely in process().
+	// Applied on next init().
+	void setBackgroundProcessing(bool bEnabled);
+
+	// Block until every requested IR has been prepared or discarded by the background thread, which
+	// uses FFT plans of AFFTPlanner. Call before clearing the planner.
+	static void waitForPendingIRs();
+
 	// ADSPBase interface
 	void init(float sampleRate) override;
 	void deinit() override;
@@ -26,50 +64,226 @@ public:
 
 private:
 
-	typedef std::complex<float> complex;
+	struct Stage;
+
+	// Multiply-adds and IFFT of one output block of a stage, run on a background worker during the
+	// block before the output is due. The FDL is captured at launch, as the stage may hand it over to
+	// a newer kernel in the meantime. The job writes its own buffers, so when a worker misses the
+	// deadline the audio thread computes the block in the stage's buffers instead of waiting for it.
+	struct TailJob
+	{
+		enum class State
+		{
+			Idle,    // nothing submitted, or the output has been collected
+			Queued,  // submitted, and may be claimed by a worker or the audio thread
+			Running, // claimed by a worker
+			Done,    // output in the job's output buffer
+			Late     // claimed by a worker that missed the deadline, whose output will be discarded
+		};
+
+		std::atomic<State> state;
+
+		// Submissions of this job still held by the background pool, which may outlive the job's run
+		std::atomic<int> queued;
+
+		Stage* stage;
+
+		// FDL and newest slot read by the worker. Only written while no worker holds the job.
+		const float* freqDelayLine;
+		size_t fdlPtr;
+
+		// Split-complex IFFT input and IFFT output of the worker, like those of the stage
+		float* ifftInput;
+		float* outputBuffer;
+
+		// Whether the next output block has been launched, and the FDL it was launched with. Only used
+		// on the audio thread, which computes the block from them if the worker is late.
+		bool bLaunched;
+		const float* launchFreqDelayLine;
+		size_t launchFdlPtr;
+
+		TailJob();
+	};
+
+	// A stage is a uniformly partitioned convolver responsible for one segment of the impulse response.
+	// The segment's spectra are shared, while the frequency delay line is private to this convolver.
+	struct Stage
+	{
+		// Shared IR segment convolved by this stage
+		const AImpulseResponse::Segment* segment;
+
+		// Partitioned, split-complex input frequency-domain delay line, using the segment's slot layout
+		float* freqDelayLine;
+
+		// Number of slots in freqDelayLine, delay + partitions
+		size_t fdlSize;
+
+		// Points to the next write index in freqDelayLine
+		size_t fdlPtr;
+
+		// Stores the most recent 2 * blockSize input samples, used as input to FFT
+		float* inputBuffer;
+
+		// Split-complex input to the final IFFT after all multiply and add operations
+		float* ifftInput;
+
+		// Output of the IFFT. The second half contains the valid output block.
+		float* outputBuffer;
+
+		// Shared input FFT plan, writing split-complex output
+		fftwf_plan fftPlan;
+
+		// Shared output IFFT plan, reading split-complex input
+		fftwf_plan ifftPlan;
+
+		// Background job of a stage processed ahead of time, or nullptr if processed in process()
+		std::unique_ptr<TailJob> job;
+
+		// Stage of the replaced IR with the same layout, whose FDL this stage took over. The next output
+		// block crossfades from it to this stage if `bCrossfade`, and collects its job if it has one.
+		Stage* replacedStage;
+		bool bCrossfade;
+
+		// Set on the stages of a replaced IR that were not taken over, whose next output block fades out
+		bool bFadeOut;
+	};
 
-	// Time-domain impulse response of this convolver. Sample rate is assumed to be that of the session.
-	std::vector<float> impulseResponse;
+	// An IR's spectra together with the private stage state to convolve them
+	struct Kernel
+	{
+		std::shared_ptr<const AImpulseResponse> impulseResponse;
 
-	// Number of FFT partitions, dependent on impulse response length
-	size_t partitions;
+		// Never resized once created, as jobs point to their stage
+		std::vector<Stage> stages;
 
-	// Partitioned, complex frequency-domain impulse response blocks
-	std::vector<complex*> impulseResponseFFTs;
+		// Waits for the background pool to release all jobs
+		~Kernel();
+	};
 
-	// Stores input samples to be used as input to FFT
-	float* inputBuffer;
+	// Hands kernels prepared on the background thread to the audio thread. Shared with pending
+	// background requests, which may outlive the convolver.
+	struct KernelExchange
+	{
+		// Prepared kernel not yet picked up by process()
+		std::atomic<Kernel*> pending;
 
-	// Output of FFT of input stream
-	complex* fftResult;
+		// Number of the newest request. Background requests superseded before they start are skipped.
+		std::atomic<uint64_t> latestRequest;
 
-	// Partitioned, complex input frequency-domain delay line
-	std::vector<complex*> freqDelayLine;
+		// Sample range changed since the last IR was prepared, merged across skipped requests.
+		// Guarded by `mutex`, which the audio thread never takes.
+		size_t changedBegin;
+		size_t changedEnd;
+		std::mutex mutex;
 
-	// Input to the final IFFT after all multiply and add operations
-	complex* ifftInput;
+		// Spectra of the most recently prepared IR, the base of incremental updates. Background thread only.
+		std::shared_ptr<const AImpulseResponse> latestIR;
 
-	// Stores final output samples to be sent to output
-	float* outputBuffer;
+		KernelExchange();
 
-	// Points to the next write index in inputBuffer
-	int inputPtr;
+		~KernelExchange();
+	};
 
-	// Points to the next write index in inputFDL
-	int fdlPtr;
+	// Time-domain impulse response set by setIR(samples). Sample rate is assumed to be that of the session.
+	std::vector<float> impulseResponseSamples;
 
-	// Input FFT plan
-	fftwf_plan fftPlan;
+	// Impulse response file set by setIR(filepath), loaded through the IR cache
+	std::string impulseResponseFilepath;
 
-	// Output IFFT plan
-	fftwf_plan ifftPlan;
+	// Partition size of the head stage, which is also the latency of the convolver
+	size_t minBlockSize;
 
-	// Called during init(), or if IR is changed after initialization. Assumes valid sampleRate.
+	// Largest partition size used by the tail stage
+	size_t maxBlockSize;
+
+	// Head and tail partition sizes of the current session, set in init()
+	size_t headBlockSize;
+	size_t tailBlockSize;
+
+	// Whether long tail stages are processed on background workers
+	bool bBackgroundProcessing;
+
+	// Stages of at least this block size are processed on background workers, set in init()
+	size_t backgroundBlockSize;
+
+	// Kernel in use by process(), with stages ordered by increasing block size
+	std::unique_ptr<Kernel> kernel;
+
+	// Kernel replaced by `kernel`, kept until its stages have faded and it can be retired
+	std::unique_ptr<Kernel> previousKernel;
+
+	// Created in init(), and replaced on deinit() so late background results are discarded
+	std::shared_ptr<KernelExchange> exchange;
+
+	// Ring buffer of the most recent 2 * tailBlockSize input samples
+	std::vector<float> inputHistory;
+
+	// Ring buffer of pending output samples accumulated by all stages, the same size as inputHistory
+	std::vector<float> outputAccumulator;
+
+	// Shared write index of both rings, also used to trigger stages at their block boundaries
+	size_t samplePtr;
+
+	// Processing time of this convolver, created in init()
+	std::shared_ptr<class AudioTimer> processTimer;
+
+	// Called during init(). Loads the IR synchronously. Assumes valid sampleRate.
 	void loadIR();
 
-	// Unload an impulse response and clean up relevant memory. Safe to call multiple times.
+	// Unload the impulse response and clean up relevant memory. Safe to call multiple times.
 	void unloadIR();
 
+	// Prepare the current IR on the background thread, to be swapped in by process(). Samples
+	// outside of [changedBegin, changedEnd) are unchanged since the previous request.
+	void requestIR(size_t changedBegin = 0, size_t changedEnd = SIZE_MAX);
+
+	// Acquire the shared spectra of an IR file, or of `samples` if `filepath` is empty
+	static std::shared_ptr<const AImpulseResponse> acquireIR(
+		const std::string& filepath,
+		const std::vector<float>& samples,
+		float sampleRate,
+		size_t minBlockSize,
+		size_t maxBlockSize);
+
+	// Allocate the stages convolving `impulseResponse`, with a job for each delayed stage of at
+	// least `backgroundBlockSize`. Returns nullptr on failure.
+	static std::unique_ptr<Kernel> createKernel(std::shared_ptr<const AImpulseResponse> impulseResponse, size_t backgroundBlockSize);
+
+	// Allocate the private state of a stage convolving `segment`. Returns success.
+	static bool loadStage(Stage& stage, const AImpulseResponse::Segment& segment, size_t backgroundBlockSize);
+
+	// Called from the audio thread on a head block boundary. Retire the previous kernel to a background
+	// worker once its fades have completed, and swap in a pending kernel, taking over the state of
+	// matching stages.
+	void swapKernel();
+
+	// True while any stage of the current or previous kernel has a pending fade
+	bool isFading() const;
+
+	// Transform the latest input block of a stage and accumulate its output into outputAccumulator
+	void processStage(Stage& stage);
+
+	// Transform the latest two blocks of input into the newest FDL slot of a stage
+	void transformInput(Stage& stage);
+
+	// Multiply the FDL `freqDelayLine` of `stage`, whose newest slot is `fdlPtr`, with the spectra of
+	// `spectra`, which has the same layout, and transform the result into `outputBuffer`. `ifftInput`
+	// and `outputBuffer` are laid out like those of the stage.
+	static void convolveStage(const Stage& stage, const AImpulseResponse::Segment& spectra, const float* freqDelayLine, size_t fdlPtr, float* ifftInput, float* outputBuffer);
+
+	// Queue the job computing the next output block of a stage, from the FDL as it is now
+	static void launchJob(Stage& stage);
+
+	// Entry point of background workers, running the TailJob `context` unless the audio thread took it
+	static void runJob(void* context);
+
+	// Entry point of background workers, freeing the retired Kernel `context`
+	static void deleteKernel(void* context);
+
+	// Collect the launched job of a stage, or compute its block on the calling thread if no worker has
+	// finished it yet. Returns the output block, or nullptr if no job was launched.
+	static const float* collectJob(Stage& stage);
+
 	// If condition is true, return true. Otherwise, call deinit() and return false
 	bool convassert(bool condition);
 };
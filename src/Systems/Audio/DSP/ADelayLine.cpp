@@ -1,24 +1,41 @@
 #include "ADelayLine.h"
+#include "ADelayLinePool.h"
 #include "../Components/AudioComponent.h"
+#include "ASIMD.h"
 #include <algorithm>
 
 // Speed of sound in air (seconds per meter)
 constexpr float soundSpeed = 0.0029154518950437f;
 
-// Maximum distance between two objects (meters)
-constexpr float maximumDistance = 10.f;
+// Input samples resampled per span in ADelayLine::write(). Bounds the stack usage of the scratch buffers.
+constexpr size_t maxResampleChunk = 256;
 
 ReadWriteBuffer::ReadWriteBuffer() :
-	readPtr(0), 
+	buffer(nullptr),
+	length(0),
+	readPtr(0),
 	writePtr(0),
 	size(0)
 {
 }
 
+ReadWriteBuffer::~ReadWriteBuffer()
+{
+	ADelayLinePool::instance().freeSamples(buffer, length);
+}
+
 void ReadWriteBuffer::init(size_t delayLength, size_t initialSize)
 {
-	buffer.clear();
-	buffer.resize(delayLength);
+	// reuse the storage if the capacity is unchanged, as it is for every init of a session
+	auto& pool = ADelayLinePool::instance();
+	if (delayLength != length) {
+		pool.freeSamples(buffer, length);
+		buffer = pool.allocateSamples(delayLength);
+		length = delayLength;
+	}
+	else {
+		std::fill_n(buffer, length, 0.f);
+	}
 	readPtr = 0;
 	writePtr = initialSize;
 	size = initialSize;
@@ -26,60 +43,76 @@ void ReadWriteBuffer::init(size_t delayLength, size_t initialSize)
 
 size_t ReadWriteBuffer::write(float sample)
 {
-	if (size == buffer.size()) return 0;
+	if (size == length) return 0;
 	buffer[writePtr++] = sample;
-	if (writePtr == buffer.size()) writePtr = 0;
+	if (writePtr == length) writePtr = 0;
 	size++;
 	return 1;
 }
 
 size_t ReadWriteBuffer::write(float* samples, size_t n)
 {
-	if (size == buffer.size()) return 0;
-	size_t f = buffer.size() - size; // free space
+	auto span = acquireWrite(n);
+	std::copy_n(samples, span.first.size(), span.first.data());
+	std::copy_n(samples + span.first.size(), span.second.size(), span.second.data());
+	commitWrite(span.size());
+	return span.size();
+}
+
+ARingSpan<float> ReadWriteBuffer::acquireWrite(size_t n)
+{
+	size_t f = length - size; // free space
 	if (n > f) n = f;
-	if (writePtr + n > buffer.size()) {
-		size_t nEnd = buffer.size() - writePtr;
-		size_t nFront = n - nEnd;
-		std::copy_n(samples, nEnd, &buffer[writePtr]);
-		std::copy_n(samples + nEnd, nFront, &buffer[0]);
-	}
-	else {
-		std::copy_n(samples, n, &buffer[writePtr]);
-	}
+	size_t nEnd = std::min(n, length - writePtr);
+
+	ARingSpan<float> span;
+	span.first = std::span<float>(buffer + writePtr, nEnd);
+	span.second = std::span<float>(buffer, n - nEnd);
+	return span;
+}
+
+void ReadWriteBuffer::commitWrite(size_t n)
+{
+	if (n == 0) return;
 	writePtr = radd(writePtr, n);
 	size += n;
-	return n;
 }
 
 size_t ReadWriteBuffer::read(float* samples, size_t n)
 {
-	if (size == 0) return 0;
+	auto span = acquireRead(n);
+	std::copy_n(span.first.data(), span.first.size(), samples);
+	std::copy_n(span.second.data(), span.second.size(), samples + span.first.size());
+	commitRead(span.size());
+	return span.size();
+}
+
+ARingSpan<const float> ReadWriteBuffer::acquireRead(size_t n)
+{
 	if (n > size) n = size;
+	size_t nEnd = std::min(n, length - readPtr);
 
-	if (readPtr + n > buffer.size()) {
-		size_t nEnd = buffer.size() - readPtr;
-		size_t nFront = n - nEnd;
-		std::copy_n(&buffer[readPtr], nEnd, samples);
-		std::copy_n(&buffer[0], nFront, samples + nEnd);
-	}
-	else {
-		std::copy_n(&buffer[readPtr], n, samples);
-	}
+	ARingSpan<const float> span;
+	span.first = std::span<const float>(buffer + readPtr, nEnd);
+	span.second = std::span<const float>(buffer, n - nEnd);
+	return span;
+}
 
+void ReadWriteBuffer::commitRead(size_t n)
+{
+	if (n == 0) return;
 	size -= n;
 	readPtr = radd(readPtr, n);
-	return n;
 }
 
 size_t ReadWriteBuffer::capacity()
 {
-	return buffer.size();
+	return length;
 }
 
 size_t ReadWriteBuffer::writeable()
 {
-	return buffer.size() - size;
+	return length - size;
 }
 
 size_t ReadWriteBuffer::readable()
@@ -94,8 +127,17 @@ ADelayLine::ADelayLine(AudioComponent* source, AudioComponent* dest) :
 	destData(nullptr),
 	genID(0),
 	bInitialized(false),
-	b{},
-	sampleInterpOffset(0.f)
+	bVirtual(false),
+	resampleQuality(AResampleQuality::Cubic),
+	resampleTable(nullptr),
+	resampleTaps(4),
+	history{},
+	sampleInterpOffset(0.f),
+	resampleStep(1.f),
+	fadeLevel(1.f),
+	fadeTarget(1.f),
+	fadeIncrement(0.f),
+	fadeRemaining(0)
 {
 }
 
@@ -106,22 +148,34 @@ float ADelayLine::velocity()
 	return mat::dot(sourceToDestDir, sourceToDestVel);
 }
 
+size_t ADelayLine::capacity(float sampleRate)
+{
+	return static_cast<size_t>(sampleRate * maximumDistance * soundSpeed);
+}
+
 void ADelayLine::init(float sampleRate)
 {
 	if (bInitialized) return;
 	bInitialized = true;
 
 	float dist = mat::dist(source->position, dest->position);
-	float fMaxSampleDelay = sampleRate * maximumDistance * soundSpeed;
 	float fInitSampleDelay = sampleRate * dist * soundSpeed;
-	size_t maxSampleDelay = static_cast<size_t>(fMaxSampleDelay);
-	size_t initSampleDelay = static_cast<size_t>(fInitSampleDelay);
+	size_t maxSampleDelay = capacity(sampleRate);
+	size_t initSampleDelay = std::min(static_cast<size_t>(fInitSampleDelay), maxSampleDelay);
 	buffer.init(maxSampleDelay, initSampleDelay);
+	resampleStep = std::max(1.f - velocity() * soundSpeed, 0.f);
+	resampleTable = AResampleTable::get(resampleQuality);
+	resampleTaps = AResampleTable::tapCount(resampleQuality);
 
 	source->initDelayLineData(this, sampleRate, true);
 	dest->initDelayLineData(this, sampleRate, false);
 }
 
+void ADelayLine::setResampleQuality(AResampleQuality quality)
+{
+	resampleQuality = quality;
+}
+
 void ADelayLine::deinit()
 {
 	if (!bInitialized) return;
@@ -133,43 +187,114 @@ void ADelayLine::deinit()
 	bInitialized = false;
 }
 
-size_t ADelayLine::write(float* samples, size_t& n)
+size_t ADelayLine::write(const float* samples, size_t& n, float gain, float gainIncrement)
 {
 	size_t inputCount = n;
 	size_t writeCount = n = 0;
-	while (buffer.writeable() && n < inputCount) {
-		if (sampleInterpOffset < 1.f) {
-			// clamp lower bound, don't allow going back in time
-			sampleInterpOffset += std::max(1.f - velocity() * soundSpeed, 0.f);
+	if (inputCount == 0) return 0;
+
+	// Sample the velocity once per block and ramp the step towards it over the expected number of
+	// outputs. Clamp the lower bound, don't allow going back in time.
+	float targetStep = std::max(1.f - velocity() * soundSpeed, 0.f);
+	float expectedOutputs = static_cast<float>(inputCount) / std::max(0.5f * (resampleStep + targetStep), 1e-3f);
+	float stepIncrement = (targetStep - resampleStep) / std::max(expectedOutputs, 1.f);
+
+	float x[historyLength + maxResampleChunk];
+	int32_t index[maxResampleChunk];
+	float t[maxResampleChunk];
+
+	while (n < inputCount) {
+		// resample into the contiguous part of the free space, wrapping on the next iteration
+		auto writeSpan = buffer.acquireWrite(maxResampleChunk).first;
+		float* out = writeSpan.data();
+		size_t span = writeSpan.size();
+		if (span == 0) break;
+
+		// after consuming `consumed` inputs, the newest input in the interpolation window is x[consumed + historyLength - 1]
+		size_t chunk = std::min(inputCount - n, maxResampleChunk);
+		std::copy_n(history, historyLength, x);
+		if (gain == 1.f && gainIncrement == 0.f) {
+			std::copy_n(samples + n, chunk, x + historyLength);
+		}
+		else {
+			for (size_t i = 0; i < chunk; i++) x[historyLength + i] = samples[n + i] * (gain + gainIncrement * static_cast<float>(n + i));
 		}
-		
-		while (sampleInterpOffset >= 1.f && n < inputCount) {
-			b[0] = b[1];
-			b[1] = b[2];
-			b[2] = b[3];
-			b[3] = samples[n++];
-			sampleInterpOffset--;
+
+		// find the input position of each output sample
+		size_t consumed = 0;
+		size_t outputs = 0;
+		while (outputs < span) {
+			if (sampleInterpOffset < 1.f) {
+				sampleInterpOffset += resampleStep;
+				resampleStep += stepIncrement;
+				if ((stepIncrement > 0.f) == (resampleStep > targetStep)) {
+					resampleStep = targetStep;
+					stepIncrement = 0.f;
+				}
+			}
+
+			while (sampleInterpOffset >= 1.f && consumed < chunk) {
+				consumed++;
+				sampleInterpOffset--;
+			}
+
+			// out of input samples
+			if (sampleInterpOffset >= 1.f) break;
+
+			index[outputs] = static_cast<int32_t>(consumed);
+			t[outputs] = sampleInterpOffset;
+			outputs++;
 		}
 
-		// out of input samples
-		if (sampleInterpOffset >= 1.f) break;
-		
-		// cubic interp
-		float t = sampleInterpOffset;
-		float a0 = b[3] - b[2] - b[0] + b[1];
-		float a1 = b[0] - b[1] - a0;
-		float a2 = b[2] - b[0];
-		float a3 = b[1];
-		float result = a0 * t * t * t + a1 * t * t + a2 * t + a3;
-		writeCount += buffer.write(result);
+		const float* window = x + historyLength - resampleTaps;
+		if (resampleTable) resampleTable->interpolate(out, window, index, t, outputs);
+		else simd::cubicInterpolate(out, window, index, t, outputs);
+		if (fadeRemaining > 0 || fadeLevel != 1.f) applyFade(out, outputs);
+		buffer.commitWrite(outputs);
+
+		std::copy_n(x + consumed, historyLength, history);
+		n += consumed;
+		writeCount += outputs;
 	}
 	return writeCount;
+}
 
-	// DEBUG no doppler
-	//size_t inputCount = n;
-	//size_t writeCount = n = 0;
-	//while (buffer.writeable() && n < inputCount) writeCount += buffer.write(samples[n++]);
-	//return writeCount;
+size_t ADelayLine::writeSilence(size_t n)
+{
+	auto span = buffer.acquireWrite(n);
+	std::fill(span.first.begin(), span.first.end(), 0.f);
+	std::fill(span.second.begin(), span.second.end(), 0.f);
+	buffer.commitWrite(span.size());
+	return span.size();
+}
+
+void ADelayLine::fadeTo(float target, size_t samples)
+{
+	fadeTarget = target;
+	if (samples == 0) {
+		fadeLevel = target;
+		fadeRemaining = 0;
+	}
+	else {
+		fadeIncrement = (target - fadeLevel) / static_cast<float>(samples);
+		fadeRemaining = samples;
+	}
+}
+
+bool ADelayLine::fadedOut() const
+{
+	return fadeRemaining == 0 && fadeLevel == 0.f;
+}
+
+void ADelayLine::applyFade(float* samples, size_t n)
+{
+	for (size_t i = 0; i < n; i++) {
+		samples[i] *= fadeLevel;
+		if (fadeRemaining > 0) {
+			fadeLevel += fadeIncrement;
+			if (--fadeRemaining == 0) fadeLevel = fadeTarget;
+		}
+	}
 }
 
 bool ADelayLine::writeable()
@@ -182,6 +307,16 @@ size_t ADelayLine::read(float* samples, size_t n)
 	return buffer.read(samples, n);
 }
 
+ARingSpan<const float> ADelayLine::acquireRead(size_t n)
+{
+	return buffer.acquireRead(n);
+}
+
+void ADelayLine::commitRead(size_t n)
+{
+	buffer.commitRead(n);
+}
+
 size_t ADelayLine::readable()
 {
 	return buffer.readable();
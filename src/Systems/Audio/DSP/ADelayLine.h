@@ -1,13 +1,20 @@
 #pragma once
 
-#include <vector>
+#include "AResampleTable.h"
+#include "ARingSpan.h"
 
+// Ring buffer of samples, stored in ADelayLinePool
 class ReadWriteBuffer
 {
 public:
 
 	ReadWriteBuffer();
 
+	~ReadWriteBuffer();
+
+	ReadWriteBuffer(const ReadWriteBuffer&) = delete;
+	ReadWriteBuffer& operator=(const ReadWriteBuffer&) = delete;
+
 	// Initialize the buffer with capacity `sampleDelay`. Optionally include `intialSize`,
 	// the initial number of zero samples
 	void init(size_t delayLength, size_t initialSize = 0);
@@ -20,9 +27,23 @@ public:
 	// This will be less than `n` if the buffer is full.
 	size_t write(float* samples, size_t n);
 
+	// Return up to `n` writeable samples of the buffer in place. Samples written to the
+	// spans are added by commitWrite().
+	ARingSpan<float> acquireWrite(size_t n);
+
+	// Add the first `n` samples written to the spans returned by acquireWrite()
+	void commitWrite(size_t n);
+
 	// Returns the number of samples read. May be less than `n`
 	size_t read(float* samples, size_t n);
 
+	// Return up to `n` readable samples of the buffer in place. The samples remain in the
+	// buffer until released by commitRead().
+	ARingSpan<const float> acquireRead(size_t n);
+
+	// Release the first `n` samples returned by acquireRead()
+	void commitRead(size_t n);
+
 	// Return the active buffer size
 	size_t capacity();
 
@@ -34,7 +55,11 @@ public:
 
 private:
 
-	std::vector<float> buffer;
+	// Ring storage allocated from ADelayLinePool, or nullptr if empty
+	float* buffer;
+
+	// Number of samples in `buffer`
+	size_t length;
 
 	// An index which points to the current read position
 	size_t readPtr;
@@ -48,7 +73,7 @@ private:
 	// Ring mod addition
 	inline size_t radd(size_t lhs, size_t rhs) {
 		size_t sum = lhs + rhs;
-		return sum >= buffer.size() ? sum % buffer.size() : sum;
+		return sum >= length ? sum % length : sum;
 	}
 
 	// Ring mod addition with custom size
@@ -59,7 +84,7 @@ private:
 
 	// Ring mod subtraction
 	inline size_t rsub(size_t lhs, size_t rhs) {
-		return lhs >= rhs ? lhs - rhs : buffer.size() - (rhs - lhs);
+		return lhs >= rhs ? lhs - rhs : length - (rhs - lhs);
 	}
 
 	// Absolute value difference
@@ -71,13 +96,22 @@ private:
 // Forward declarations
 class AudioComponent;
 
-// ADelayLine is used to connect two different, unobstructed AudioComponent objects
+// ADelayLine is used to connect two different, unobstructed AudioComponent objects. Delay lines are
+// created by ADelayLinePool and referred to by their index in the pool.
 class ADelayLine
 {
 public:
 
 	ADelayLine(AudioComponent* source, AudioComponent* dest);
 
+	// Maximum distance between the source and destination (meters), which the buffer is sized for.
+	// AudioScene only connects components within this distance.
+	static constexpr float maximumDistance = 10.f;
+
+	// Number of samples a delay line holds at `sampleRate`, the propagation time over maximumDistance.
+	// A block processed at once must not be longer, or the samples beyond it are dropped.
+	static size_t capacity(float sampleRate);
+
 	// Relative velocity of distance between source and destination, in meters per second.
 	// Velocity is positive if distance is increasing, or negative if decreasing.
 	float velocity();
@@ -88,10 +122,25 @@ public:
 	// Clean up internals and delete any memory allocated in init(). It is safe to call multiple times.
 	void deinit();
 
+	// Set the interpolation used for Doppler resampling. Applied on next init(). AudioScene selects it
+	// from the relative speed of source and destination when connecting them.
+	void setResampleQuality(AResampleQuality quality);
+
 	// Push samples to the delay line. Returns the number of samples outputted to the delay line,
 	// which may be more or less than `n` due to doppler effects or the output buffer filling up.
-	// The number of input samples consumed is assigned to `n`, and may be less than `n`
-	size_t write(float* samples, size_t& n);
+	// The number of input samples consumed is assigned to `n`, and may be less than `n`.
+	// Input sample i is scaled by `gain + i * gainIncrement` as it is staged for resampling.
+	size_t write(const float* samples, size_t& n, float gain = 1.f, float gainIncrement = 0.f);
+
+	// Push `n` silent samples without resampling, keeping a virtual connection in time with the
+	// source. Returns the number of samples written, which may be less than `n` if the buffer fills up.
+	size_t writeSilence(size_t n);
+
+	// Ramp the level of written samples linearly to `target` over `samples` output samples
+	void fadeTo(float target, size_t samples);
+
+	// Return true if written samples are faded out completely
+	bool fadedOut() const;
 
 	// Return true if this buffer is not full
 	bool writeable();
@@ -99,6 +148,12 @@ public:
 	// Returns the number of samples read, which may be less than `n`
 	size_t read(float* samples, size_t n);
 
+	// Return up to `n` delayed samples in place, without copying. Release them with commitRead().
+	ARingSpan<const float> acquireRead(size_t n);
+
+	// Release the first `n` samples returned by acquireRead()
+	void commitRead(size_t n);
+
 	// Returns the number of samples available for reading
 	size_t readable();
 
@@ -120,13 +175,41 @@ public:
 	// True after init() has been called and before deinit() has been called
 	bool bInitialized;
 
+	// Set by AudioScene on the audio thread for inaudible connections. A virtual connection is faded
+	// out, after which its source only keeps it in time with processVirtual().
+	bool bVirtual;
+
 private:
 
 	ReadWriteBuffer buffer;
 
-	// Stores the four most recent input samples, used for velocity-dependent cubic interpolation
-	float b[4];
+	// Interpolation used for Doppler resampling
+	AResampleQuality resampleQuality;
+
+	// Filter bank of resampleQuality, or nullptr for cubic interpolation. Set in init().
+	const AResampleTable* resampleTable;
+
+	// Number of input samples read per output by resampleQuality
+	size_t resampleTaps;
 
-	// [0, 1). Fractional sample offset from interpBuffer[1]
+	// Length of the input history, the largest number of taps of any resampling quality
+	static constexpr size_t historyLength = 16;
+
+	// Stores the most recent input samples, used for velocity-dependent interpolation
+	float history[historyLength];
+
+	// [0, 1). Fractional sample offset from the interpolation base sample
 	float sampleInterpOffset;
+
+	// Input samples advanced per output sample. Ramped each block towards the value given by velocity().
+	float resampleStep;
+
+	// Level applied to written samples, ramped towards fadeTarget for fadeRemaining more samples
+	float fadeLevel;
+	float fadeTarget;
+	float fadeIncrement;
+	size_t fadeRemaining;
+
+	// Apply and advance the fade over `n` written samples
+	void applyFade(float* samples, size_t n);
 };
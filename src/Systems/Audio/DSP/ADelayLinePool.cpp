@@ -0,0 +1,128 @@
+#include "ADelayLinePool.h"
+#include <algorithm>
+#include <cstdio>
+#include <new>
+
+// Samples per chunk of ring buffer storage, enough for many rings at any common sample rate
+constexpr size_t samplesPerChunk = 1 << 20;
+
+// Rings are rounded up to a multiple of this many samples, so each one starts on a cache line
+constexpr size_t sampleAlignment = 16;
+
+ADelayLinePool::ADelayLinePool() :
+	slabCount(0),
+	nextIndex(0),
+	liveCount(0),
+	chunkPtr(nullptr),
+	chunkRemaining(0)
+{
+}
+
+ADelayLinePool::~ADelayLinePool()
+{
+	for (size_t s = 0; s < slabCount; s++) {
+		for (auto& slot : slabs[s]->slots) {
+			if (slot.references > 0) slot.delayline.~ADelayLine();
+		}
+	}
+	for (float* chunk : chunks) ::operator delete[](chunk, std::align_val_t(sampleAlignment * sizeof(float)));
+}
+
+ADelayLinePool& ADelayLinePool::instance()
+{
+	static ADelayLinePool instance;
+	return instance;
+}
+
+uint32_t ADelayLinePool::create(AudioComponent* source, AudioComponent* dest)
+{
+	uint32_t index;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!freeIndices.empty()) {
+			index = freeIndices.back();
+			freeIndices.pop_back();
+		}
+		else {
+			if (slabCount == 0 || nextIndex == (1u << slabShift)) {
+				if (slabCount == maxSlabs) {
+					printf("Delay line pool is full, connection not created.\n");
+					return invalidIndex;
+				}
+				slabs[slabCount++] = std::make_unique<Slab>();
+				nextIndex = 0;
+			}
+			index = (static_cast<uint32_t>(slabCount - 1) << slabShift) | nextIndex++;
+		}
+		liveCount++;
+	}
+
+	Slot& slot = slabs[index >> slabShift]->slots[index & slabMask];
+	new (&slot.delayline) ADelayLine(source, dest);
+	slot.references = 1;
+	return index;
+}
+
+void ADelayLinePool::retain(uint32_t index)
+{
+	slabs[index >> slabShift]->slots[index & slabMask].references++;
+}
+
+void ADelayLinePool::release(uint32_t index)
+{
+	Slot& slot = slabs[index >> slabShift]->slots[index & slabMask];
+	if (--slot.references > 0) return;
+
+	// frees the ring buffer back into the pool
+	slot.delayline.~ADelayLine();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	freeIndices.push_back(index);
+	liveCount--;
+}
+
+size_t ADelayLinePool::size() const
+{
+	return liveCount;
+}
+
+float* ADelayLinePool::allocateSamples(size_t n)
+{
+	if (n == 0) return nullptr;
+	size_t rounded = (n + sampleAlignment - 1) / sampleAlignment * sampleAlignment;
+
+	float* samples = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		auto it = freeSamplesBySize.find(rounded);
+		if (it != freeSamplesBySize.end() && !it->second.empty()) {
+			samples = it->second.back();
+			it->second.pop_back();
+		}
+		else {
+			// the remainder of the current chunk is abandoned if too small, which only happens
+			// once per chunk since all rings of a session have the same size
+			if (rounded > chunkRemaining) {
+				size_t chunkSize = std::max(rounded, samplesPerChunk);
+				chunkPtr = static_cast<float*>(::operator new[](chunkSize * sizeof(float), std::align_val_t(sampleAlignment * sizeof(float))));
+				chunkRemaining = chunkSize;
+				chunks.push_back(chunkPtr);
+			}
+			samples = chunkPtr;
+			chunkPtr += rounded;
+			chunkRemaining -= rounded;
+		}
+	}
+
+	std::fill_n(samples, n, 0.f);
+	return samples;
+}
+
+void ADelayLinePool::freeSamples(float* samples, size_t n)
+{
+	if (!samples) return;
+	size_t rounded = (n + sampleAlignment - 1) / sampleAlignment * sampleAlignment;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	freeSamplesBySize[rounded].push_back(samples);
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ADelayLine.h"
+#include <array>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+
+// ADelayLinePool owns every delay line and its ring buffer storage. Delay lines live in fixed-size
+// slabs, so they never move and are addressed by a compact index, and ring buffers are carved out of
+// large sample chunks, so the rings of connections created together are adjacent in memory. Freed
+// slots and rings are reused by later connections instead of returning to the heap.
+//
+// Delay lines are created and destroyed outside the audio thread. The audio thread only looks them up
+// and moves references between component lists, neither of which takes a lock.
+class ADelayLinePool
+{
+public:
+
+	// Returned by create() when the pool is full
+	static constexpr uint32_t invalidIndex = UINT32_MAX;
+
+	static ADelayLinePool& instance();
+
+	ADelayLinePool(const ADelayLinePool&) = delete;
+	ADelayLinePool& operator=(const ADelayLinePool&) = delete;
+
+	// Create a delay line connecting `source` to `dest`, with one reference held by the caller.
+	// Returns its index, or invalidIndex if the pool is full.
+	uint32_t create(class AudioComponent* source, class AudioComponent* dest);
+
+	// Add a reference to the delay line at `index`, for each component list it is added to
+	void retain(uint32_t index);
+
+	// Remove a reference to the delay line at `index`. The last reference destroys the delay line
+	// and frees its slot, which must not happen on the audio thread. A component always holds its
+	// own connections until it is deleted, and connections removed by AudioScene keep a reference
+	// until freed outside the audio thread, so the audio thread never drops the last.
+	void release(uint32_t index);
+
+	ADelayLine& operator[](uint32_t index)
+	{
+		return slabs[index >> slabShift]->slots[index & slabMask].delayline;
+	}
+
+	// Number of live delay lines
+	size_t size() const;
+
+	// Allocate `n` zeroed samples of ring buffer storage
+	float* allocateSamples(size_t n);
+
+	// Return storage of `n` samples from allocateSamples() for reuse
+	void freeSamples(float* samples, size_t n);
+
+private:
+
+	ADelayLinePool();
+
+	~ADelayLinePool();
+
+	// log2 of the number of delay lines per slab
+	static constexpr uint32_t slabShift = 8;
+	static constexpr uint32_t slabMask = (1u << slabShift) - 1;
+
+	// Upper bound of slabs, so the slab table never reallocates under the audio thread
+	static constexpr size_t maxSlabs = 1024;
+
+	// Storage of one delay line, constructed and destroyed in place
+	struct Slot
+	{
+		union
+		{
+			ADelayLine delayline;
+		};
+
+		// Component lists holding this delay line
+		uint32_t references;
+
+		Slot() : references(0) {}
+		~Slot() {}
+	};
+
+	struct Slab
+	{
+		Slot slots[1u << slabShift];
+	};
+
+	std::array<std::unique_ptr<Slab>, maxSlabs> slabs;
+
+	// Number of slabs allocated
+	size_t slabCount;
+
+	// Indices of destroyed delay lines, reused most recently freed first while their slots are warm
+	std::vector<uint32_t> freeIndices;
+
+	// Number of slots handed out from the newest slab
+	uint32_t nextIndex;
+
+	size_t liveCount;
+
+	// Sample chunks backing all rings, freed on destruction
+	std::vector<float*> chunks;
+
+	// Unused samples at the end of the newest chunk
+	float* chunkPtr;
+	size_t chunkRemaining;
+
+	// Freed rings by rounded size
+	std::map<size_t, std::vector<float*>> freeSamplesBySize;
+
+	// Guards allocation and freeing of slots and samples, never taken by the audio thread
+	std::mutex mutex;
+};
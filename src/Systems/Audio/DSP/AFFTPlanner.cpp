@@ -0,0 +1,83 @@
+#include "AFFTPlanner.h"
+
+AFFTPlanner::AFFTPlanner()
+{
+}
+
+AFFTPlanner::~AFFTPlanner()
+{
+	clear();
+}
+
+AFFTPlanner& AFFTPlanner::instance()
+{
+	static AFFTPlanner instance;
+	return instance;
+}
+
+fftwf_plan AFFTPlanner::forward(size_t N)
+{
+	return plan(N, true);
+}
+
+fftwf_plan AFFTPlanner::inverse(size_t N)
+{
+	return plan(N, false);
+}
+
+bool AFFTPlanner::loadWisdom(const std::string& filepath)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return fftwf_import_wisdom_from_filename(filepath.c_str()) != 0;
+}
+
+bool AFFTPlanner::saveWisdom(const std::string& filepath)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!fftwf_export_wisdom_to_filename(filepath.c_str())) {
+		printf("Unable to save FFTW wisdom: %s\n", filepath.c_str());
+		return false;
+	}
+	return true;
+}
+
+void AFFTPlanner::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto& plan : plans) fftwf_destroy_plan(plan.second);
+	plans.clear();
+}
+
+fftwf_plan AFFTPlanner::plan(size_t N, bool bForward)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto key = std::make_pair(N, bForward);
+	auto it = plans.find(key);
+	if (it != plans.end()) return it->second;
+
+	// Plan on scratch arrays, since measuring overwrites them. They are not needed afterwards,
+	// as users always execute with their own arrays of the same alignment.
+	const size_t bins = N / 2 + 1;
+	float* real = fftwf_alloc_real(N);
+	float* complexRe = fftwf_alloc_real(bins);
+	float* complexIm = fftwf_alloc_real(bins);
+
+	fftwf_plan p = nullptr;
+	if (real && complexRe && complexIm) {
+		fftwf_iodim dim = { static_cast<int>(N), 1, 1 };
+		if (bForward) {
+			p = fftwf_plan_guru_split_dft_r2c(1, &dim, 0, nullptr, real, complexRe, complexIm, FFTW_MEASURE | FFTW_PRESERVE_INPUT);
+		}
+		else {
+			p = fftwf_plan_guru_split_dft_c2r(1, &dim, 0, nullptr, complexRe, complexIm, real, FFTW_MEASURE | FFTW_DESTROY_INPUT);
+		}
+	}
+
+	if (real) fftwf_free(real);
+	if (complexRe) fftwf_free(complexRe);
+	if (complexIm) fftwf_free(complexIm);
+
+	if (p) plans[key] = p;
+	return p;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <fftw3.h>
+#include <string>
+#include <map>
+#include <utility>
+#include <mutex>
+
+// AFFTPlanner owns one FFTW plan per (size, direction), shared by every user of that transform.
+// Plans are split-complex and must be run with the new-array execute functions on arrays allocated
+// by fftwf_alloc_real() (or 64 byte aligned offsets into them). Planning is serialized internally.
+class AFFTPlanner
+{
+public:
+
+	// Return the real to split-complex plan of size `N`, creating it if necessary.
+	// Execute with fftwf_execute_split_dft_r2c(). The input is preserved.
+	fftwf_plan forward(size_t N);
+
+	// Return the split-complex to real plan of size `N`, creating it if necessary.
+	// Execute with fftwf_execute_split_dft_c2r(). The input is destroyed.
+	fftwf_plan inverse(size_t N);
+
+	// Import accumulated FFTW wisdom from disk. Returns success.
+	bool loadWisdom(const std::string& filepath);
+
+	// Export accumulated FFTW wisdom to disk. Returns success.
+	bool saveWisdom(const std::string& filepath);
+
+	// Destroy all plans. Only call when no user holds a plan returned by forward() or inverse().
+	void clear();
+
+private:
+
+	AFFTPlanner();
+
+	~AFFTPlanner();
+
+	// Find or create the plan for `N`, forward or inverse
+	fftwf_plan plan(size_t N, bool bForward);
+
+	// Shared plans, keyed by size and direction (true for forward)
+	std::map<std::pair<size_t, bool>, fftwf_plan> plans;
+
+	// The FFTW planner is not thread safe
+	std::mutex mutex;
+
+public:
+
+	static AFFTPlanner& instance();
+
+	// Deleted functions prevent singleton duplication
+	AFFTPlanner(AFFTPlanner const&) = delete;
+	void operator=(AFFTPlanner const&) = delete;
+};
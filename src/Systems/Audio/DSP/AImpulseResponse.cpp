@@ -0,0 +1,231 @@
+#include "AImpulseResponse.h"
+#include "AFFTPlanner.h"
+#include "../AWAVFile.h"
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+// Number of partitions in the head segment. Must be odd so that the next segment's
+// offset plus latency is a multiple of its (doubled) block size.
+constexpr size_t headPartitions = 3;
+
+// Number of partitions in each intermediate segment. Must be even, for the same reason.
+constexpr size_t segmentPartitions = 2;
+
+// Spectrum slots are padded to a multiple of this many floats (one 64 byte cache line), which
+// keeps every slot at the alignment FFTW planned for and lets kernels run full vector widths
+constexpr size_t simdPadding = 16;
+
+AImpulseResponse::AImpulseResponse(const std::vector<float>& samples, size_t minBlockSize, size_t maxBlockSize) :
+	length(samples.size())
+{
+	size_t offset = 0;
+	size_t blockSize = minBlockSize;
+	while (offset < samples.size()) {
+		size_t remainingBlocks = (samples.size() - offset + blockSize - 1) / blockSize;
+		size_t partitions = remainingBlocks;
+		if (blockSize < maxBlockSize) {
+			partitions = std::min(segments.empty() ? headPartitions : segmentPartitions, remainingBlocks);
+		}
+
+		Segment segment;
+		segment.blockSize = blockSize;
+		segment.bins = blockSize + 1;
+		segment.stride = (segment.bins + simdPadding - 1) / simdPadding * simdPadding;
+		segment.delay = (offset + minBlockSize) / blockSize - 1;
+		segment.partitions = partitions;
+		segment.offset = offset;
+		if (!allocateSpectra(segment)) {
+			segments.clear();
+			return;
+		}
+
+		std::fill_n(segment.spectra, segment.stride * 2 * partitions, 0.f);
+		if (!transformPartitions(segment, samples, 0, partitions)) {
+			segments.clear();
+			return;
+		}
+		segments.push_back(segment);
+
+		offset += partitions * blockSize;
+		if (blockSize < maxBlockSize) blockSize *= 2;
+	}
+}
+
+AImpulseResponse::AImpulseResponse(const AImpulseResponse& base, const std::vector<float>& samples, size_t changedBegin, size_t changedEnd) :
+	length(samples.size())
+{
+	changedEnd = std::min(changedEnd, samples.size());
+
+	for (const Segment& baseSegment : base.segments) {
+		Segment& segment = segments.emplace_back(baseSegment);
+
+		// partitions overlapping the changed range
+		size_t segmentEnd = segment.offset + segment.partitions * segment.blockSize;
+		if (changedBegin >= changedEnd || changedEnd <= segment.offset || changedBegin >= segmentEnd) continue;
+		size_t first = (std::max(changedBegin, segment.offset) - segment.offset) / segment.blockSize;
+		size_t last = (std::min(changedEnd, segmentEnd) - segment.offset + segment.blockSize - 1) / segment.blockSize;
+
+		// copy on write, leaving the base spectra intact for convolvers still using them
+		if (!allocateSpectra(segment)) {
+			segments.clear();
+			return;
+		}
+		std::copy_n(baseSegment.spectra, segment.stride * 2 * segment.partitions, segment.spectra);
+		if (!transformPartitions(segment, samples, first, last)) {
+			segments.clear();
+			return;
+		}
+	}
+}
+
+bool AImpulseResponse::allocateSpectra(Segment& segment)
+{
+	segment.spectra = fftwf_alloc_real(segment.stride * 2 * segment.partitions);
+	segment.spectraOwner.reset(segment.spectra, fftwf_free);
+	return segment.spectra != nullptr;
+}
+
+bool AImpulseResponse::transformPartitions(Segment& segment, const std::vector<float>& samples, size_t first, size_t last)
+{
+	const size_t blockSize = segment.blockSize;
+	const size_t N = blockSize * 2;
+	float* fftIn = fftwf_alloc_real(N);
+	fftwf_plan p = AFFTPlanner::instance().forward(N);
+	if (!fftIn || !p) {
+		if (fftIn) fftwf_free(fftIn);
+		return false;
+	}
+
+	// transform IR partitions directly into their slots, zero padding the input
+	std::fill_n(fftIn, N, 0.f);
+	for (size_t i = first; i < last; i++) {
+		size_t partitionStart = segment.offset + blockSize * i;
+		size_t count = partitionStart < samples.size() ? std::min(blockSize, samples.size() - partitionStart) : 0;
+		std::copy_n(samples.data() + partitionStart, count, fftIn);
+		std::fill_n(fftIn + count, blockSize - count, 0.f);
+
+		float* irSlot = segment.slot(segment.spectra, i);
+		fftwf_execute_split_dft_r2c(p, fftIn, irSlot, irSlot + segment.stride);
+
+		// fold the unnormalized IFFT scale into the spectra, so convolver output needs no scaling
+		const float scale = 1.f / static_cast<float>(N);
+		for (size_t j = 0; j < segment.stride * 2; j++) irSlot[j] *= scale;
+	}
+
+	fftwf_free(fftIn);
+	return true;
+}
+
+AImpulseResponseCache::AImpulseResponseCache()
+{
+}
+
+AImpulseResponseCache& AImpulseResponseCache::instance()
+{
+	static AImpulseResponseCache instance;
+	return instance;
+}
+
+bool AImpulseResponseCache::Key::operator<(const Key& other) const
+{
+	return std::tie(filepath, hash, length, sampleRate, minBlockSize, maxBlockSize) <
+		std::tie(other.filepath, other.hash, other.length, other.sampleRate, other.minBlockSize, other.maxBlockSize);
+}
+
+std::shared_ptr<const AImpulseResponse> AImpulseResponseCache::acquire(
+	const std::string& filepath,
+	float sampleRate,
+	size_t minBlockSize,
+	size_t maxBlockSize)
+{
+	// a file read before may still have a live entry
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		prune();
+		auto content = fileContents.find(filepath);
+		if (content != fileContents.end()) {
+			Key key{ filepath, content->second.hash, content->second.length, sampleRate, minBlockSize, maxBlockSize };
+			if (auto ir = find(key)) return ir;
+		}
+	}
+
+	// otherwise (re)read the file, which may have changed on disk since
+	AWAVFile wav(filepath);
+	if (wav.data.empty() || wav.channels != 1) {
+		fprintf(stderr, "Incompatible wav file.\n");
+		return nullptr;
+	}
+
+	Key key{ filepath, hash(wav.data), wav.data.size(), sampleRate, minBlockSize, maxBlockSize };
+	{
+		// the content may match an entry of other block sizes, or one created while reading
+		std::lock_guard<std::mutex> lock(mutex);
+		fileContents[filepath] = FileContent{ key.hash, key.length };
+		if (auto ir = find(key)) return ir;
+	}
+
+	return publish(key, std::make_shared<const AImpulseResponse>(wav.data, minBlockSize, maxBlockSize));
+}
+
+std::shared_ptr<const AImpulseResponse> AImpulseResponseCache::acquire(
+	const std::vector<float>& samples,
+	float sampleRate,
+	size_t minBlockSize,
+	size_t maxBlockSize)
+{
+	Key key{ std::string(), hash(samples), samples.size(), sampleRate, minBlockSize, maxBlockSize };
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		prune();
+		if (auto ir = find(key)) return ir;
+	}
+
+	return publish(key, std::make_shared<const AImpulseResponse>(samples, minBlockSize, maxBlockSize));
+}
+
+std::shared_ptr<const AImpulseResponse> AImpulseResponseCache::find(const Key& key) const
+{
+	auto entry = entries.find(key);
+	return entry != entries.end() ? entry->second.lock() : nullptr;
+}
+
+std::shared_ptr<const AImpulseResponse> AImpulseResponseCache::publish(const Key& key, std::shared_ptr<const AImpulseResponse> ir)
+{
+	// if another thread transformed the same IR meanwhile, its spectra are shared and these are dropped
+	std::lock_guard<std::mutex> lock(mutex);
+	if (auto existing = find(key)) return existing;
+	entries[key] = ir;
+	return ir;
+}
+
+void AImpulseResponseCache::prune()
+{
+	// drop entries whose last user has released them
+	for (auto it = entries.begin(); it != entries.end();) {
+		if (it->second.expired()) it = entries.erase(it);
+		else it++;
+	}
+
+	// forget files without a live entry, which are read again when next used. Entries are ordered by
+	// filepath first, so the first entry not below the smallest key of a file tells if it has any.
+	for (auto it = fileContents.begin(); it != fileContents.end();) {
+		Key first{ it->first, 0, 0, -std::numeric_limits<float>::infinity(), 0, 0 };
+		auto entry = entries.lower_bound(first);
+		if (entry == entries.end() || entry->first.filepath != it->first) it = fileContents.erase(it);
+		else it++;
+	}
+}
+
+uint64_t AImpulseResponseCache::hash(const std::vector<float>& samples)
+{
+	const auto* bytes = reinterpret_cast<const unsigned char*>(samples.data());
+	size_t count = samples.size() * sizeof(float);
+
+	uint64_t h = 14695981039346656037ull;
+	for (size_t i = 0; i < count; i++) {
+		h ^= bytes[i];
+		h *= 1099511628211ull;
+	}
+	return h;
+}
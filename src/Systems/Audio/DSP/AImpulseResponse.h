@@ -0,0 +1,148 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// AImpulseResponse holds the immutable, partitioned frequency-domain spectra of an impulse response
+// for a given non-uniform partition layout. Instances are shared by all convolvers using the same IR.
+struct AImpulseResponse
+{
+	// A segment is the run of equally sized IR partitions handled by one convolver stage. Spectra
+	// are stored split-complex: each slot of `bins` values holds all real parts, followed by all
+	// imaginary parts, each padded to `stride` floats. Slots are contiguous within one allocation.
+	struct Segment
+	{
+		// Partition size of this segment. The FFT size is twice the partition size.
+		size_t blockSize;
+
+		// Number of frequency bins per spectrum, blockSize + 1
+		size_t bins;
+
+		// Padded length of the real or imaginary half of a spectrum slot
+		size_t stride;
+
+		// Number of FDL blocks between the newest input spectrum and the first partition of this segment
+		size_t delay;
+
+		// Number of IR partitions in this segment
+		size_t partitions;
+
+		// Position of the first partition in the time-domain IR
+		size_t offset;
+
+		// Partitioned, split-complex frequency-domain impulse response blocks, pre-scaled by 1 / FFT size
+		float* spectra;
+
+		// Owns `spectra`. Segments untouched by an incremental update share their spectra with the previous IR.
+		std::shared_ptr<float> spectraOwner;
+
+		// Return the real part of spectrum slot `i` of `data`. The imaginary part follows at + stride.
+		float* slot(float* data, size_t i) const { return data + i * 2 * stride; }
+		const float* slot(const float* data, size_t i) const { return data + i * 2 * stride; }
+	};
+
+	// Partition the time-domain `samples` into segments of doubling block size, from `minBlockSize`
+	// up to `maxBlockSize`, and transform every partition. Both sizes must be powers of two.
+	AImpulseResponse(const std::vector<float>& samples, size_t minBlockSize, size_t maxBlockSize);
+
+	// Create the spectra of `samples`, which differ from the samples of `base` only in the range
+	// [changedBegin, changedEnd). Only partitions overlapping the range are transformed again, the
+	// spectra of untouched segments are shared. `samples` must be as long as the samples of `base`.
+	AImpulseResponse(const AImpulseResponse& base, const std::vector<float>& samples, size_t changedBegin, size_t changedEnd);
+
+	AImpulseResponse(AImpulseResponse const&) = delete;
+	void operator=(AImpulseResponse const&) = delete;
+
+	// Segments ordered by increasing block size. Empty if the IR is empty or allocation failed.
+	std::vector<Segment> segments;
+
+	// Number of time-domain samples
+	size_t length;
+
+private:
+
+	// Allocate the spectra of `segment`. Returns success.
+	static bool allocateSpectra(Segment& segment);
+
+	// Transform partitions [first, last) of `segment` from `samples`, zero padding past the end of the IR.
+	// Returns success.
+	static bool transformPartitions(Segment& segment, const std::vector<float>& samples, size_t first, size_t last);
+};
+
+// AImpulseResponseCache hands out shared impulse response spectra, so that convolvers using the same IR
+// do not each read and transform it. Entries are reference counted and released with their last user.
+class AImpulseResponseCache
+{
+public:
+
+	// Return the spectra of the mono wav file at `filepath`, reading and transforming it only if
+	// no live entry matches. Returns nullptr if the file cannot be used as an impulse response.
+	std::shared_ptr<const AImpulseResponse> acquire(
+		const std::string& filepath,
+		float sampleRate,
+		size_t minBlockSize,
+		size_t maxBlockSize);
+
+	// Return the spectra of `samples`, transforming them only if no live entry has the same content
+	std::shared_ptr<const AImpulseResponse> acquire(
+		const std::vector<float>& samples,
+		float sampleRate,
+		size_t minBlockSize,
+		size_t maxBlockSize);
+
+private:
+
+	AImpulseResponseCache();
+
+	struct Key
+	{
+		std::string filepath;
+		uint64_t hash;
+		size_t length;
+		float sampleRate;
+		size_t minBlockSize;
+		size_t maxBlockSize;
+
+		bool operator<(const Key& other) const;
+	};
+
+	// Return the live entry for `key`, or nullptr. Requires `mutex`.
+	std::shared_ptr<const AImpulseResponse> find(const Key& key) const;
+
+	// Store `ir` as the entry for `key` and return it, unless another thread has stored a live entry
+	// for `key` in the meantime, which is returned instead
+	std::shared_ptr<const AImpulseResponse> publish(const Key& key, std::shared_ptr<const AImpulseResponse> ir);
+
+	// Remove expired entries, and the contents of files left without a live entry. Requires `mutex`.
+	void prune();
+
+	// Live entries. Expired entries are removed on the next lookup.
+	std::map<Key, std::weak_ptr<const AImpulseResponse>> entries;
+
+	struct FileContent
+	{
+		uint64_t hash;
+		size_t length;
+	};
+
+	// Content hash of previously read files, so that cached files need not be read again
+	std::map<std::string, FileContent> fileContents;
+
+	// Convolvers may be initialized from any thread. Files are read and transformed without holding
+	// the lock, so that a slow load does not hold up other convolvers.
+	std::mutex mutex;
+
+	// 64-bit FNV-1a hash of the IR samples
+	static uint64_t hash(const std::vector<float>& samples);
+
+public:
+
+	static AImpulseResponseCache& instance();
+
+	// Deleted functions prevent singleton duplication
+	AImpulseResponseCache(AImpulseResponseCache const&) = delete;
+	void operator=(AImpulseResponseCache const&) = delete;
+};
@@ -1,16 +1,66 @@
 #include "AInterpParameter.h"
+#include "ASIMD.h"
 #include <cmath>
 
 AInterpParameter::AInterpParameter(float initialValue, float interpRate) :
 	target(initialValue),
 	current(initialValue),
 	rate(interpRate),
-	sampleRate(44100.f) // best guess
+	sampleRate(44100.f), // best guess
+	cachedSteps(0),
+	cachedDecay(1.f)
 {
+	updateDecay();
+}
+
+void AInterpParameter::setRate(float interpRate)
+{
+	rate = interpRate;
+	updateDecay();
+}
+
+void AInterpParameter::setSampleRate(float sampleRate)
+{
+	this->sampleRate = sampleRate;
+	updateDecay();
 }
 
 float AInterpParameter::update(size_t steps)
 {
-	current += (target - current) * (1.f - expf(-static_cast<float>(steps) / (sampleRate * rate)));
+	current = target + (current - target) * decayFor(steps);
 	return current;
 }
+
+float AInterpParameter::peek(size_t steps) const
+{
+	return target + (current - target) * decayFor(steps);
+}
+
+void AInterpParameter::fill(float* ramp, size_t n)
+{
+	simd::exponentialRamp(ramp, nullptr, target, current, decay, n);
+	update(n);
+}
+
+void AInterpParameter::apply(float* samples, size_t n)
+{
+	simd::exponentialRamp(samples, samples, target, current, decay, n);
+	update(n);
+}
+
+void AInterpParameter::updateDecay()
+{
+	decay = expf(-1.f / (sampleRate * rate));
+	cachedSteps = 0;
+	cachedDecay = 1.f;
+}
+
+float AInterpParameter::decayFor(size_t steps) const
+{
+	if (steps == 1) return decay;
+	if (steps != cachedSteps) {
+		cachedDecay = expf(-static_cast<float>(steps) / (sampleRate * rate));
+		cachedSteps = steps;
+	}
+	return cachedDecay;
+}
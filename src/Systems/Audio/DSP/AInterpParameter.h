@@ -10,16 +10,46 @@ struct AInterpParameter
 	// Current parameter value
 	float current;
 
-	// Interp rate time constant (seconds)
-	float rate;
+	AInterpParameter(float initialValue, float interpRate = 0.1f);
 
-	// Sample rate, must set initialized before use
-	float sampleRate;
+	// Set the interp rate time constant (seconds)
+	void setRate(float interpRate);
 
-	AInterpParameter(float initialValue, float interpRate = 0.1f);
+	// Set the sample rate, must be set before use
+	void setSampleRate(float sampleRate);
 
 	// Update the parameter by the provided number of steps.
 	// If no parameter is given, value is updated by a single step.
 	// Returns the new current value.
 	float update(size_t steps = 1);
+
+	// Returns the value the parameter would have after `steps` steps, without updating it
+	float peek(size_t steps) const;
+
+	// Write the values of the next `n` steps to `ramp` and update the parameter by `n` steps
+	void fill(float* ramp, size_t n);
+
+	// Multiply `samples` by the values of the next `n` steps and update the parameter by `n` steps
+	void apply(float* samples, size_t n);
+
+private:
+
+	// Interp rate time constant (seconds)
+	float rate;
+
+	// Sample rate of the steps
+	float sampleRate;
+
+	// Factor the distance to the target decays by per step. Updated with the rate and sample rate.
+	float decay;
+
+	// Decay over `cachedSteps` steps, since blocks are usually updated by the same number of steps
+	mutable size_t cachedSteps;
+	mutable float cachedDecay;
+
+	// Recompute the decay after the rate or sample rate changed
+	void updateDecay();
+
+	// Returns the decay over `steps` steps
+	float decayFor(size_t steps) const;
 };
@@ -0,0 +1,108 @@
+#include "AOscillatorBank.h"
+#include <algorithm>
+#include <cmath>
+
+// Samples of white noise filtered per pass when generating pink noise. Bounds the stack usage.
+constexpr size_t pinkNoiseChunk = 256;
+
+namespace
+{
+	// Derive distinct, non-zero generator states from a seed
+	uint32_t splitmix(uint64_t& seed)
+	{
+		uint64_t z = (seed += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		uint32_t state = static_cast<uint32_t>(z ^ (z >> 31));
+		return state ? state : 1;
+	}
+}
+
+AOscillatorBank::AOscillatorBank() :
+	sampleRate(44100.f) // best guess
+{
+}
+
+size_t AOscillatorBank::addVoice(AWaveform waveform, float frequency, float amplitude)
+{
+	Voice voice = {};
+	voice.waveform = waveform;
+	voice.frequency = frequency;
+	voice.amplitude = amplitude;
+	voice.wavetable = AWavetable::get(waveform);
+
+	// every voice gets its own noise sequence
+	uint64_t seed = voices.size() * simd::noiseLanes + 1;
+	for (auto& state : voice.noiseState) state = splitmix(seed);
+
+	updateVoice(voice);
+	voices.push_back(voice);
+	return voices.size() - 1;
+}
+
+void AOscillatorBank::clear()
+{
+	voices.clear();
+}
+
+void AOscillatorBank::setFrequency(size_t voice, float frequency)
+{
+	voices[voice].frequency = frequency;
+	updateVoice(voices[voice]);
+}
+
+void AOscillatorBank::setAmplitude(size_t voice, float amplitude)
+{
+	voices[voice].amplitude = amplitude;
+}
+
+void AOscillatorBank::init(float sampleRate)
+{
+	this->sampleRate = sampleRate;
+	for (auto& voice : voices) updateVoice(voice);
+}
+
+void AOscillatorBank::process(float* out, size_t n)
+{
+	std::fill_n(out, n, 0.f);
+
+	for (auto& voice : voices) {
+		if (voice.amplitude == 0.f) continue;
+
+		switch (voice.waveform) {
+		case AWaveform::WhiteNoise:
+			simd::noiseAccumulate(out, voice.noiseState, voice.amplitude, n);
+			break;
+		case AWaveform::PinkNoise: {
+			// Paul Kellet's economy pink noise filter
+			float white[pinkNoiseChunk];
+			for (size_t offset = 0; offset < n; offset += pinkNoiseChunk) {
+				size_t chunk = std::min(pinkNoiseChunk, n - offset);
+				std::fill_n(white, chunk, 0.f);
+				simd::noiseAccumulate(white, voice.noiseState, 1.f, chunk);
+				float* s = voice.pinkState;
+				for (size_t i = 0; i < chunk; i++) {
+					s[0] = 0.99765f * s[0] + white[i] * 0.0990460f;
+					s[1] = 0.96300f * s[1] + white[i] * 0.2965164f;
+					s[2] = 0.57000f * s[2] + white[i] * 1.0526913f;
+					out[offset + i] += voice.amplitude * 0.25f * (s[0] + s[1] + s[2] + white[i] * 0.1848f);
+				}
+			}
+			break;
+		}
+		default:
+			simd::wavetableAccumulate(out, voice.table, AWavetable::tableBits, voice.phase, voice.increment, voice.amplitude, n);
+			voice.phase += static_cast<uint32_t>(n) * voice.increment;
+		}
+	}
+}
+
+void AOscillatorBank::updateVoice(Voice& voice)
+{
+	if (!voice.wavetable) return;
+
+	double cycles = static_cast<double>(voice.frequency) / static_cast<double>(sampleRate);
+	cycles -= std::floor(cycles);
+	voice.increment = static_cast<uint32_t>(std::llround(cycles * 4294967296.0));
+	voice.table = voice.wavetable->level(static_cast<float>(voice.frequency / sampleRate));
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "AWavetable.h"
+#include "ASIMD.h"
+#include <vector>
+
+// AOscillatorBank sums any number of generator voices into one signal. Periodic voices read
+// band-limited wavetables with a 32-bit phase accumulator, which wraps exactly once per cycle and
+// does not lose precision over long sessions. Noise voices run several generators in SIMD lanes.
+class AOscillatorBank
+{
+public:
+
+	AOscillatorBank();
+
+	// Add a voice and return its index. `frequency` is in Hz and ignored by noise voices.
+	size_t addVoice(AWaveform waveform, float frequency, float amplitude);
+
+	// Remove all voices
+	void clear();
+
+	void setFrequency(size_t voice, float frequency);
+
+	void setAmplitude(size_t voice, float amplitude);
+
+	// Set the session sample rate. Must be called before process().
+	void init(float sampleRate);
+
+	// Write the sum of all voices to `out`
+	void process(float* out, size_t n);
+
+private:
+
+	struct Voice
+	{
+		AWaveform waveform;
+		float frequency;
+		float amplitude;
+
+		// Shared wavetable, or nullptr for noise voices
+		const AWavetable* wavetable;
+
+		// Wavetable level for the current frequency
+		const float* table;
+
+		// Phase in 1/2^32 cycles, and its advance per sample
+		uint32_t phase;
+		uint32_t increment;
+
+		// Noise generator states
+		uint32_t noiseState[simd::noiseLanes];
+
+		// Pink noise filter states
+		float pinkState[3];
+	};
+
+	// Recompute the wavetable level and phase increment of a voice
+	void updateVoice(Voice& voice);
+
+	std::vector<Voice> voices;
+
+	float sampleRate;
+};
@@ -0,0 +1,85 @@
+#include "AResampleTable.h"
+#include "ASIMD.h"
+#include <cmath>
+
+// Number of tabulated phases per input sample
+constexpr size_t tablePhases = 256;
+
+namespace
+{
+	double sinc(double x)
+	{
+		constexpr double pi = 3.14159265358979323846;
+		return x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+	}
+
+	// Blackman window over [-1, 1]
+	double blackman(double x)
+	{
+		constexpr double pi = 3.14159265358979323846;
+		if (x <= -1.0 || x >= 1.0) return 0.0;
+		return 0.42 + 0.5 * std::cos(pi * x) + 0.08 * std::cos(2.0 * pi * x);
+	}
+}
+
+AResampleTable::AResampleTable(size_t taps, double cutoff) :
+	taps(taps),
+	phases(tablePhases)
+{
+	// Tabulate one more phase than used, which is the first phase shifted by one sample,
+	// so that the last phase has a difference to interpolate towards
+	std::vector<double> table((phases + 1) * taps);
+	const double halfWidth = static_cast<double>(taps) / 2.0;
+	for (size_t p = 0; p <= phases; p++) {
+		double t = static_cast<double>(p) / static_cast<double>(phases);
+		double* row = table.data() + p * taps;
+
+		double sum = 0.0;
+		for (size_t k = 0; k < taps; k++) {
+			// distance of tap k from the interpolated position, which lies between taps / 2 - 1 and taps / 2
+			double d = static_cast<double>(k) - (halfWidth - 1.0) - t;
+			row[k] = cutoff * sinc(cutoff * d) * blackman(d / halfWidth);
+			sum += row[k];
+		}
+
+		// normalize to unity gain at DC for every phase
+		for (size_t k = 0; k < taps; k++) row[k] /= sum;
+	}
+
+	coefficients.resize(phases * taps);
+	deltas.resize(phases * taps);
+	for (size_t i = 0; i < phases * taps; i++) {
+		coefficients[i] = static_cast<float>(table[i]);
+		deltas[i] = static_cast<float>(table[i + taps] - table[i]);
+	}
+}
+
+const AResampleTable* AResampleTable::get(AResampleQuality quality)
+{
+	switch (quality) {
+	case AResampleQuality::Sinc8: {
+		static const AResampleTable table(8, 0.85);
+		return &table;
+	}
+	case AResampleQuality::Sinc16: {
+		static const AResampleTable table(16, 0.92);
+		return &table;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+size_t AResampleTable::tapCount(AResampleQuality quality)
+{
+	switch (quality) {
+	case AResampleQuality::Sinc8: return 8;
+	case AResampleQuality::Sinc16: return 16;
+	default: return 4;
+	}
+}
+
+void AResampleTable::interpolate(float* out, const float* x, const int32_t* index, const float* t, size_t n) const
+{
+	simd::polyphaseInterpolate(out, x, index, t, n, coefficients.data(), deltas.data(), taps, phases);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Quality tiers of the fractional-delay interpolation used for Doppler resampling
+enum class AResampleQuality
+{
+	// Four-point cubic interpolation. Cheapest, but aliases audibly at high Doppler ratios.
+	Cubic,
+
+	// 8-tap windowed sinc
+	Sinc8,
+
+	// 16-tap windowed sinc, for fast moving sources
+	Sinc16
+};
+
+// AResampleTable is a precomputed polyphase windowed-sinc filter bank for fractional-delay interpolation.
+// Coefficients between two tabulated phases are interpolated linearly (a first order Farrow structure),
+// so each tap costs two multiply-adds and no transcendental functions at runtime.
+class AResampleTable
+{
+public:
+
+	// Return the shared table for a sinc quality tier, building it on first use.
+	// Returns nullptr for tiers which don't use a table.
+	static const AResampleTable* get(AResampleQuality quality);
+
+	// Return the number of input samples read per output sample for a quality tier
+	static size_t tapCount(AResampleQuality quality);
+
+	// Interpolate `n` fractional positions. out[j] interpolates between x[index[j] + taps / 2 - 1] and
+	// x[index[j] + taps / 2] at fraction t[j] in [0, 1), reading x[index[j]] to x[index[j] + taps - 1].
+	void interpolate(float* out, const float* x, const int32_t* index, const float* t, size_t n) const;
+
+	// Number of filter taps
+	const size_t taps;
+
+	// Number of tabulated phases between two input samples
+	const size_t phases;
+
+private:
+
+	// Build the table for a filter of `taps` taps with cutoff `cutoff`, relative to Nyquist
+	AResampleTable(size_t taps, double cutoff);
+
+	// `taps` coefficients for each phase
+	std::vector<float> coefficients;
+
+	// Difference of each phase's coefficients to those of the next phase
+	std::vector<float> deltas;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <span>
+
+// ARingSpan refers to a region of a ring buffer as up to two contiguous ranges, in order.
+// The second range is only non-empty if the region wraps around the end of the ring.
+template<typename T>
+struct ARingSpan
+{
+	std::span<T> first;
+	std::span<T> second;
+
+	// Total number of samples in both ranges
+	size_t size() const { return first.size() + second.size(); }
+};
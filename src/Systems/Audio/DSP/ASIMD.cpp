@@ -0,0 +1,1004 @@
+#include "ASIMD.h"
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang require per-function target attributes to emit instructions beyond the
+// compiler's baseline. MSVC emits any intrinsic regardless of the /arch setting.
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
+
+namespace
+{
+	// SSE2 adds the integer operations of the oscillator kernels. All other kernels only need SSE.
+	enum class InstructionSet
+	{
+		Scalar,
+		SSE,
+		SSE2,
+		AVX2,
+		AVX512,
+		NEON
+	};
+
+	InstructionSet detectInstructionSet()
+	{
+#if defined(SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool bSSE = info[3] & (1 << 25);
+		bool bSSE2 = info[3] & (1 << 26);
+		bool bFMA = info[2] & (1 << 12);
+		bool bOSXSAVE = info[2] & (1 << 27);
+
+		bool bAVX2 = false;
+		bool bAVX512 = false;
+		if (maxLeaf >= 7 && bOSXSAVE) {
+			__cpuidex(info, 7, 0);
+			unsigned long long xcr0 = _xgetbv(0);
+			bool bYMM = (xcr0 & 0x06) == 0x06;
+			bool bZMM = (xcr0 & 0xe6) == 0xe6;
+			bAVX2 = bYMM && bFMA && (info[1] & (1 << 5));
+			bAVX512 = bZMM && (info[1] & (1 << 16));
+		}
+#else
+		__builtin_cpu_init();
+		bool bSSE = __builtin_cpu_supports("sse");
+		bool bSSE2 = __builtin_cpu_supports("sse2");
+		bool bAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+		bool bAVX512 = __builtin_cpu_supports("avx512f");
+#endif
+		if (bAVX512) return InstructionSet::AVX512;
+		if (bAVX2) return InstructionSet::AVX2;
+		if (bSSE2) return InstructionSet::SSE2;
+		if (bSSE) return InstructionSet::SSE;
+		return InstructionSet::Scalar;
+#elif defined(SIMD_NEON)
+		return InstructionSet::NEON;
+#else
+		return InstructionSet::Scalar;
+#endif
+	}
+
+	const InstructionSet activeInstructionSet = detectInstructionSet();
+
+	/** Complex multiply-accumulate */
+
+	void complexMultiplyAddScalar(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		size_t n)
+	{
+		for (size_t i = 0; i < n; i++) {
+			accRe[i] += aRe[i] * bRe[i] - aIm[i] * bIm[i];
+			accIm[i] += aRe[i] * bIm[i] + aIm[i] * bRe[i];
+		}
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse")
+	void complexMultiplyAddSSE(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			__m128 ar = _mm_loadu_ps(aRe + i);
+			__m128 ai = _mm_loadu_ps(aIm + i);
+			__m128 br = _mm_loadu_ps(bRe + i);
+			__m128 bi = _mm_loadu_ps(bIm + i);
+			__m128 re = _mm_sub_ps(_mm_mul_ps(ar, br), _mm_mul_ps(ai, bi));
+			__m128 im = _mm_add_ps(_mm_mul_ps(ar, bi), _mm_mul_ps(ai, br));
+			_mm_storeu_ps(accRe + i, _mm_add_ps(_mm_loadu_ps(accRe + i), re));
+			_mm_storeu_ps(accIm + i, _mm_add_ps(_mm_loadu_ps(accIm + i), im));
+		}
+		complexMultiplyAddScalar(accRe + i, accIm + i, aRe + i, aIm + i, bRe + i, bIm + i, n - i);
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void complexMultiplyAddAVX2(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		size_t n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256 ar = _mm256_loadu_ps(aRe + i);
+			__m256 ai = _mm256_loadu_ps(aIm + i);
+			__m256 br = _mm256_loadu_ps(bRe + i);
+			__m256 bi = _mm256_loadu_ps(bIm + i);
+			__m256 re = _mm256_fmadd_ps(ar, br, _mm256_loadu_ps(accRe + i));
+			__m256 im = _mm256_fmadd_ps(ar, bi, _mm256_loadu_ps(accIm + i));
+			_mm256_storeu_ps(accRe + i, _mm256_fnmadd_ps(ai, bi, re));
+			_mm256_storeu_ps(accIm + i, _mm256_fmadd_ps(ai, br, im));
+		}
+		complexMultiplyAddScalar(accRe + i, accIm + i, aRe + i, aIm + i, bRe + i, bIm + i, n - i);
+	}
+
+	SIMD_TARGET("avx512f")
+	void complexMultiplyAddAVX512(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		size_t n)
+	{
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512 ar = _mm512_loadu_ps(aRe + i);
+			__m512 ai = _mm512_loadu_ps(aIm + i);
+			__m512 br = _mm512_loadu_ps(bRe + i);
+			__m512 bi = _mm512_loadu_ps(bIm + i);
+			__m512 re = _mm512_fmadd_ps(ar, br, _mm512_loadu_ps(accRe + i));
+			__m512 im = _mm512_fmadd_ps(ar, bi, _mm512_loadu_ps(accIm + i));
+			_mm512_storeu_ps(accRe + i, _mm512_fnmadd_ps(ai, bi, re));
+			_mm512_storeu_ps(accIm + i, _mm512_fmadd_ps(ai, br, im));
+		}
+		complexMultiplyAddScalar(accRe + i, accIm + i, aRe + i, aIm + i, bRe + i, bIm + i, n - i);
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void complexMultiplyAddNEON(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			float32x4_t ar = vld1q_f32(aRe + i);
+			float32x4_t ai = vld1q_f32(aIm + i);
+			float32x4_t br = vld1q_f32(bRe + i);
+			float32x4_t bi = vld1q_f32(bIm + i);
+			float32x4_t re = vmlaq_f32(vld1q_f32(accRe + i), ar, br);
+			float32x4_t im = vmlaq_f32(vld1q_f32(accIm + i), ar, bi);
+			vst1q_f32(accRe + i, vmlsq_f32(re, ai, bi));
+			vst1q_f32(accIm + i, vmlaq_f32(im, ai, br));
+		}
+		complexMultiplyAddScalar(accRe + i, accIm + i, aRe + i, aIm + i, bRe + i, bIm + i, n - i);
+	}
+#endif
+
+	typedef void (*ComplexMultiplyAddFn)(float*, float*, const float*, const float*, const float*, const float*, size_t);
+
+	ComplexMultiplyAddFn selectComplexMultiplyAdd()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return complexMultiplyAddAVX512;
+		case InstructionSet::AVX2: return complexMultiplyAddAVX2;
+		case InstructionSet::SSE2:
+		case InstructionSet::SSE: return complexMultiplyAddSSE;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return complexMultiplyAddNEON;
+#endif
+		default: return complexMultiplyAddScalar;
+		}
+	}
+
+	const ComplexMultiplyAddFn complexMultiplyAddImpl = selectComplexMultiplyAdd();
+
+	/** Cubic interpolation */
+
+	void cubicInterpolateScalar(float* out, const float* x, const int32_t* index, const float* t, size_t n)
+	{
+		for (size_t i = 0; i < n; i++) {
+			const float* b = x + index[i];
+			float a0 = b[3] - b[2] - b[0] + b[1];
+			float a1 = b[0] - b[1] - a0;
+			float a2 = b[2] - b[0];
+			out[i] = ((a0 * t[i] + a1) * t[i] + a2) * t[i] + b[1];
+		}
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse")
+	void cubicInterpolateSSE(float* out, const float* x, const int32_t* index, const float* t, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			const float* p0 = x + index[i];
+			const float* p1 = x + index[i + 1];
+			const float* p2 = x + index[i + 2];
+			const float* p3 = x + index[i + 3];
+			__m128 b0 = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+			__m128 b1 = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+			__m128 b2 = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+			__m128 b3 = _mm_setr_ps(p0[3], p1[3], p2[3], p3[3]);
+			__m128 tt = _mm_loadu_ps(t + i);
+			__m128 a0 = _mm_sub_ps(_mm_add_ps(_mm_sub_ps(b3, b2), b1), b0);
+			__m128 a1 = _mm_sub_ps(_mm_sub_ps(b0, b1), a0);
+			__m128 a2 = _mm_sub_ps(b2, b0);
+			__m128 r = _mm_add_ps(_mm_mul_ps(a0, tt), a1);
+			r = _mm_add_ps(_mm_mul_ps(r, tt), a2);
+			r = _mm_add_ps(_mm_mul_ps(r, tt), b1);
+			_mm_storeu_ps(out + i, r);
+		}
+		cubicInterpolateScalar(out + i, x, index + i, t + i, n - i);
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void cubicInterpolateAVX2(float* out, const float* x, const int32_t* index, const float* t, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + i));
+			__m256 b0 = _mm256_i32gather_ps(x, idx, 4);
+			__m256 b1 = _mm256_i32gather_ps(x + 1, idx, 4);
+			__m256 b2 = _mm256_i32gather_ps(x + 2, idx, 4);
+			__m256 b3 = _mm256_i32gather_ps(x + 3, idx, 4);
+			__m256 tt = _mm256_loadu_ps(t + i);
+			__m256 a0 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(b3, b2), b1), b0);
+			__m256 a1 = _mm256_sub_ps(_mm256_sub_ps(b0, b1), a0);
+			__m256 a2 = _mm256_sub_ps(b2, b0);
+			__m256 r = _mm256_fmadd_ps(a0, tt, a1);
+			r = _mm256_fmadd_ps(r, tt, a2);
+			r = _mm256_fmadd_ps(r, tt, b1);
+			_mm256_storeu_ps(out + i, r);
+		}
+		cubicInterpolateScalar(out + i, x, index + i, t + i, n - i);
+	}
+
+	SIMD_TARGET("avx512f")
+	void cubicInterpolateAVX512(float* out, const float* x, const int32_t* index, const float* t, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512i idx = _mm512_loadu_si512(index + i);
+			__m512 b0 = _mm512_i32gather_ps(idx, x, 4);
+			__m512 b1 = _mm512_i32gather_ps(idx, x + 1, 4);
+			__m512 b2 = _mm512_i32gather_ps(idx, x + 2, 4);
+			__m512 b3 = _mm512_i32gather_ps(idx, x + 3, 4);
+			__m512 tt = _mm512_loadu_ps(t + i);
+			__m512 a0 = _mm512_sub_ps(_mm512_add_ps(_mm512_sub_ps(b3, b2), b1), b0);
+			__m512 a1 = _mm512_sub_ps(_mm512_sub_ps(b0, b1), a0);
+			__m512 a2 = _mm512_sub_ps(b2, b0);
+			__m512 r = _mm512_fmadd_ps(a0, tt, a1);
+			r = _mm512_fmadd_ps(r, tt, a2);
+			r = _mm512_fmadd_ps(r, tt, b1);
+			_mm512_storeu_ps(out + i, r);
+		}
+		cubicInterpolateScalar(out + i, x, index + i, t + i, n - i);
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void cubicInterpolateNEON(float* out, const float* x, const int32_t* index, const float* t, size_t n)
+	{
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			float taps[4][4];
+			for (size_t lane = 0; lane < 4; lane++) {
+				const float* p = x + index[i + lane];
+				for (size_t k = 0; k < 4; k++) taps[k][lane] = p[k];
+			}
+			float32x4_t b0 = vld1q_f32(taps[0]);
+			float32x4_t b1 = vld1q_f32(taps[1]);
+			float32x4_t b2 = vld1q_f32(taps[2]);
+			float32x4_t b3 = vld1q_f32(taps[3]);
+			float32x4_t tt = vld1q_f32(t + i);
+			float32x4_t a0 = vsubq_f32(vaddq_f32(vsubq_f32(b3, b2), b1), b0);
+			float32x4_t a1 = vsubq_f32(vsubq_f32(b0, b1), a0);
+			float32x4_t a2 = vsubq_f32(b2, b0);
+			float32x4_t r = vmlaq_f32(a1, a0, tt);
+			r = vmlaq_f32(a2, r, tt);
+			r = vmlaq_f32(b1, r, tt);
+			vst1q_f32(out + i, r);
+		}
+		cubicInterpolateScalar(out + i, x, index + i, t + i, n - i);
+	}
+#endif
+
+	typedef void (*CubicInterpolateFn)(float*, const float*, const int32_t*, const float*, size_t);
+
+	CubicInterpolateFn selectCubicInterpolate()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return cubicInterpolateAVX512;
+		case InstructionSet::AVX2: return cubicInterpolateAVX2;
+		case InstructionSet::SSE2:
+		case InstructionSet::SSE: return cubicInterpolateSSE;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return cubicInterpolateNEON;
+#endif
+		default: return cubicInterpolateScalar;
+		}
+	}
+
+	const CubicInterpolateFn cubicInterpolateImpl = selectCubicInterpolate();
+
+	/** Polyphase interpolation */
+
+	// Split a fractional position into a table phase and the fraction between it and the next
+	inline size_t tablePhase(float t, size_t phases, float& fraction)
+	{
+		float p = t * static_cast<float>(phases);
+		size_t phase = static_cast<size_t>(p);
+		if (phase >= phases) phase = phases - 1;
+		fraction = p - static_cast<float>(phase);
+		return phase;
+	}
+
+	void polyphaseInterpolateScalar(
+		float* out, const float* x, const int32_t* index, const float* t, size_t n,
+		const float* coefficients, const float* deltas, size_t taps, size_t phases)
+	{
+		for (size_t i = 0; i < n; i++) {
+			float f;
+			size_t offset = tablePhase(t[i], phases, f) * taps;
+			const float* c = coefficients + offset;
+			const float* d = deltas + offset;
+			const float* xs = x + index[i];
+			float acc = 0.f;
+			for (size_t k = 0; k < taps; k++) acc += (c[k] + f * d[k]) * xs[k];
+			out[i] = acc;
+		}
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse")
+	void polyphaseInterpolateSSE(
+		float* out, const float* x, const int32_t* index, const float* t, size_t n,
+		const float* coefficients, const float* deltas, size_t taps, size_t phases)
+	{
+		for (size_t i = 0; i < n; i++) {
+			float f;
+			size_t offset = tablePhase(t[i], phases, f) * taps;
+			const float* c = coefficients + offset;
+			const float* d = deltas + offset;
+			const float* xs = x + index[i];
+			__m128 ff = _mm_set1_ps(f);
+			__m128 acc = _mm_setzero_ps();
+			for (size_t k = 0; k < taps; k += 4) {
+				__m128 coef = _mm_add_ps(_mm_loadu_ps(c + k), _mm_mul_ps(ff, _mm_loadu_ps(d + k)));
+				acc = _mm_add_ps(acc, _mm_mul_ps(coef, _mm_loadu_ps(xs + k)));
+			}
+			acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+			acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+			out[i] = _mm_cvtss_f32(acc);
+		}
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void polyphaseInterpolateAVX2(
+		float* out, const float* x, const int32_t* index, const float* t, size_t n,
+		const float* coefficients, const float* deltas, size_t taps, size_t phases)
+	{
+		if (taps % 8) {
+			polyphaseInterpolateSSE(out, x, index, t, n, coefficients, deltas, taps, phases);
+			return;
+		}
+
+		for (size_t i = 0; i < n; i++) {
+			float f;
+			size_t offset = tablePhase(t[i], phases, f) * taps;
+			const float* c = coefficients + offset;
+			const float* d = deltas + offset;
+			const float* xs = x + index[i];
+			__m256 ff = _mm256_set1_ps(f);
+			__m256 acc = _mm256_setzero_ps();
+			for (size_t k = 0; k < taps; k += 8) {
+				__m256 coef = _mm256_fmadd_ps(ff, _mm256_loadu_ps(d + k), _mm256_loadu_ps(c + k));
+				acc = _mm256_fmadd_ps(coef, _mm256_loadu_ps(xs + k), acc);
+			}
+			__m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+			sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+			sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+			out[i] = _mm_cvtss_f32(sum);
+		}
+	}
+
+	SIMD_TARGET("avx512f")
+	void polyphaseInterpolateAVX512(
+		float* out, const float* x, const int32_t* index, const float* t, size_t n,
+		const float* coefficients, const float* deltas, size_t taps, size_t phases)
+	{
+		if (taps % 16) {
+			polyphaseInterpolateAVX2(out, x, index, t, n, coefficients, deltas, taps, phases);
+			return;
+		}
+
+		for (size_t i = 0; i < n; i++) {
+			float f;
+			size_t offset = tablePhase(t[i], phases, f) * taps;
+			const float* c = coefficients + offset;
+			const float* d = deltas + offset;
+			const float* xs = x + index[i];
+			__m512 ff = _mm512_set1_ps(f);
+			__m512 acc = _mm512_setzero_ps();
+			for (size_t k = 0; k < taps; k += 16) {
+				__m512 coef = _mm512_fmadd_ps(ff, _mm512_loadu_ps(d + k), _mm512_loadu_ps(c + k));
+				acc = _mm512_fmadd_ps(coef, _mm512_loadu_ps(xs + k), acc);
+			}
+			out[i] = _mm512_reduce_add_ps(acc);
+		}
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void polyphaseInterpolateNEON(
+		float* out, const float* x, const int32_t* index, const float* t, size_t n,
+		const float* coefficients, const float* deltas, size_t taps, size_t phases)
+	{
+		for (size_t i = 0; i < n; i++) {
+			float f;
+			size_t offset = tablePhase(t[i], phases, f) * taps;
+			const float* c = coefficients + offset;
+			const float* d = deltas + offset;
+			const float* xs = x + index[i];
+			float32x4_t acc = vdupq_n_f32(0.f);
+			for (size_t k = 0; k < taps; k += 4) {
+				float32x4_t coef = vmlaq_n_f32(vld1q_f32(c + k), vld1q_f32(d + k), f);
+				acc = vmlaq_f32(acc, coef, vld1q_f32(xs + k));
+			}
+			float32x2_t sum = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+			out[i] = vget_lane_f32(vpadd_f32(sum, sum), 0);
+		}
+	}
+#endif
+
+	typedef void (*PolyphaseInterpolateFn)(float*, const float*, const int32_t*, const float*, size_t, const float*, const float*, size_t, size_t);
+
+	PolyphaseInterpolateFn selectPolyphaseInterpolate()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return polyphaseInterpolateAVX512;
+		case InstructionSet::AVX2: return polyphaseInterpolateAVX2;
+		case InstructionSet::SSE2:
+		case InstructionSet::SSE: return polyphaseInterpolateSSE;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return polyphaseInterpolateNEON;
+#endif
+		default: return polyphaseInterpolateScalar;
+		}
+	}
+
+	const PolyphaseInterpolateFn polyphaseInterpolateImpl = selectPolyphaseInterpolate();
+	/** Gain accumulate */
+
+	void gainAccumulateScalar(float* acc, const float* x, float gain, float gainIncrement, size_t n)
+	{
+		for (size_t i = 0; i < n; i++) {
+			acc[i] += x[i] * (gain + gainIncrement * static_cast<float>(i));
+		}
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse")
+	void gainAccumulateSSE(float* acc, const float* x, float gain, float gainIncrement, size_t n)
+	{
+		size_t i = 0;
+		__m128 g = _mm_add_ps(_mm_set1_ps(gain), _mm_mul_ps(_mm_setr_ps(0.f, 1.f, 2.f, 3.f), _mm_set1_ps(gainIncrement)));
+		__m128 step = _mm_set1_ps(gainIncrement * 4.f);
+		for (; i + 4 <= n; i += 4) {
+			_mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_loadu_ps(x + i), g)));
+			g = _mm_add_ps(g, step);
+		}
+		gainAccumulateScalar(acc + i, x + i, gain + gainIncrement * static_cast<float>(i), gainIncrement, n - i);
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void gainAccumulateAVX2(float* acc, const float* x, float gain, float gainIncrement, size_t n)
+	{
+		size_t i = 0;
+		__m256 g = _mm256_fmadd_ps(_mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f), _mm256_set1_ps(gainIncrement), _mm256_set1_ps(gain));
+		__m256 step = _mm256_set1_ps(gainIncrement * 8.f);
+		for (; i + 8 <= n; i += 8) {
+			_mm256_storeu_ps(acc + i, _mm256_fmadd_ps(_mm256_loadu_ps(x + i), g, _mm256_loadu_ps(acc + i)));
+			g = _mm256_add_ps(g, step);
+		}
+		gainAccumulateScalar(acc + i, x + i, gain + gainIncrement * static_cast<float>(i), gainIncrement, n - i);
+	}
+
+	SIMD_TARGET("avx512f")
+	void gainAccumulateAVX512(float* acc, const float* x, float gain, float gainIncrement, size_t n)
+	{
+		size_t i = 0;
+		__m512 lanes = _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f);
+		__m512 g = _mm512_fmadd_ps(lanes, _mm512_set1_ps(gainIncrement), _mm512_set1_ps(gain));
+		__m512 step = _mm512_set1_ps(gainIncrement * 16.f);
+		for (; i + 16 <= n; i += 16) {
+			_mm512_storeu_ps(acc + i, _mm512_fmadd_ps(_mm512_loadu_ps(x + i), g, _mm512_loadu_ps(acc + i)));
+			g = _mm512_add_ps(g, step);
+		}
+		gainAccumulateScalar(acc + i, x + i, gain + gainIncrement * static_cast<float>(i), gainIncrement, n - i);
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void gainAccumulateNEON(float* acc, const float* x, float gain, float gainIncrement, size_t n)
+	{
+		size_t i = 0;
+		const float lanes[4] = { 0.f, 1.f, 2.f, 3.f };
+		float32x4_t g = vmlaq_f32(vdupq_n_f32(gain), vld1q_f32(lanes), vdupq_n_f32(gainIncrement));
+		float32x4_t step = vdupq_n_f32(gainIncrement * 4.f);
+		for (; i + 4 <= n; i += 4) {
+			vst1q_f32(acc + i, vmlaq_f32(vld1q_f32(acc + i), vld1q_f32(x + i), g));
+			g = vaddq_f32(g, step);
+		}
+		gainAccumulateScalar(acc + i, x + i, gain + gainIncrement * static_cast<float>(i), gainIncrement, n - i);
+	}
+#endif
+
+	typedef void (*GainAccumulateFn)(float*, const float*, float, float, size_t);
+
+	GainAccumulateFn selectGainAccumulate()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return gainAccumulateAVX512;
+		case InstructionSet::AVX2: return gainAccumulateAVX2;
+		case InstructionSet::SSE2:
+		case InstructionSet::SSE: return gainAccumulateSSE;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return gainAccumulateNEON;
+#endif
+		default: return gainAccumulateScalar;
+		}
+	}
+
+	const GainAccumulateFn gainAccumulateImpl = selectGainAccumulate();
+	/** Exponential ramp */
+
+	// Powers decay^1 to decay^lanes, and decay^lanes
+	inline float rampPowers(float* powers, float decay, size_t lanes)
+	{
+		float p = decay;
+		for (size_t j = 0; j < lanes; j++) {
+			powers[j] = p;
+			p *= decay;
+		}
+		return powers[lanes - 1];
+	}
+
+	void exponentialRampScalar(float* out, const float* in, float target, float start, float decay, size_t n)
+	{
+		float deviation = start - target;
+		for (size_t i = 0; i < n; i++) {
+			deviation *= decay;
+			out[i] = in ? in[i] * (target + deviation) : target + deviation;
+		}
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse")
+	void exponentialRampSSE(float* out, const float* in, float target, float start, float decay, size_t n)
+	{
+		float powers[4];
+		const float stepDecay = rampPowers(powers, decay, 4);
+		size_t i = 0;
+		__m128 t = _mm_set1_ps(target);
+		__m128 d = _mm_mul_ps(_mm_set1_ps(start - target), _mm_loadu_ps(powers));
+		__m128 step = _mm_set1_ps(stepDecay);
+		for (; i + 4 <= n; i += 4) {
+			__m128 r = _mm_add_ps(t, d);
+			_mm_storeu_ps(out + i, in ? _mm_mul_ps(_mm_loadu_ps(in + i), r) : r);
+			d = _mm_mul_ps(d, step);
+		}
+		float deviation = (start - target) * std::pow(decay, static_cast<float>(i));
+		exponentialRampScalar(out + i, in ? in + i : nullptr, target, target + deviation, decay, n - i);
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void exponentialRampAVX2(float* out, const float* in, float target, float start, float decay, size_t n)
+	{
+		float powers[8];
+		const float stepDecay = rampPowers(powers, decay, 8);
+		size_t i = 0;
+		__m256 t = _mm256_set1_ps(target);
+		__m256 d = _mm256_mul_ps(_mm256_set1_ps(start - target), _mm256_loadu_ps(powers));
+		__m256 step = _mm256_set1_ps(stepDecay);
+		for (; i + 8 <= n; i += 8) {
+			__m256 r = _mm256_add_ps(t, d);
+			_mm256_storeu_ps(out + i, in ? _mm256_mul_ps(_mm256_loadu_ps(in + i), r) : r);
+			d = _mm256_mul_ps(d, step);
+		}
+		float deviation = (start - target) * std::pow(decay, static_cast<float>(i));
+		exponentialRampScalar(out + i, in ? in + i : nullptr, target, target + deviation, decay, n - i);
+	}
+
+	SIMD_TARGET("avx512f")
+	void exponentialRampAVX512(float* out, const float* in, float target, float start, float decay, size_t n)
+	{
+		float powers[16];
+		const float stepDecay = rampPowers(powers, decay, 16);
+		size_t i = 0;
+		__m512 t = _mm512_set1_ps(target);
+		__m512 d = _mm512_mul_ps(_mm512_set1_ps(start - target), _mm512_loadu_ps(powers));
+		__m512 step = _mm512_set1_ps(stepDecay);
+		for (; i + 16 <= n; i += 16) {
+			__m512 r = _mm512_add_ps(t, d);
+			_mm512_storeu_ps(out + i, in ? _mm512_mul_ps(_mm512_loadu_ps(in + i), r) : r);
+			d = _mm512_mul_ps(d, step);
+		}
+		float deviation = (start - target) * std::pow(decay, static_cast<float>(i));
+		exponentialRampScalar(out + i, in ? in + i : nullptr, target, target + deviation, decay, n - i);
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void exponentialRampNEON(float* out, const float* in, float target, float start, float decay, size_t n)
+	{
+		float powers[4];
+		const float stepDecay = rampPowers(powers, decay, 4);
+		size_t i = 0;
+		float32x4_t t = vdupq_n_f32(target);
+		float32x4_t d = vmulq_n_f32(vld1q_f32(powers), start - target);
+		for (; i + 4 <= n; i += 4) {
+			float32x4_t r = vaddq_f32(t, d);
+			vst1q_f32(out + i, in ? vmulq_f32(vld1q_f32(in + i), r) : r);
+			d = vmulq_n_f32(d, stepDecay);
+		}
+		float deviation = (start - target) * std::pow(decay, static_cast<float>(i));
+		exponentialRampScalar(out + i, in ? in + i : nullptr, target, target + deviation, decay, n - i);
+	}
+#endif
+
+	typedef void (*ExponentialRampFn)(float*, const float*, float, float, float, size_t);
+
+	ExponentialRampFn selectExponentialRamp()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return exponentialRampAVX512;
+		case InstructionSet::AVX2: return exponentialRampAVX2;
+		case InstructionSet::SSE2:
+		case InstructionSet::SSE: return exponentialRampSSE;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return exponentialRampNEON;
+#endif
+		default: return exponentialRampScalar;
+		}
+	}
+
+	const ExponentialRampFn exponentialRampImpl = selectExponentialRamp();
+	/** Wavetable oscillator */
+
+	void wavetableAccumulateScalar(
+		float* out, const float* table, size_t tableBits,
+		uint32_t phase, uint32_t increment, float amplitude, size_t n)
+	{
+		const uint32_t shift = 32 - static_cast<uint32_t>(tableBits);
+		const uint32_t fractionMask = (uint32_t(1) << shift) - 1;
+		const float fractionScale = 1.f / static_cast<float>(uint32_t(1) << shift);
+		for (size_t i = 0; i < n; i++) {
+			uint32_t index = phase >> shift;
+			float t = static_cast<float>(phase & fractionMask) * fractionScale;
+			float a = table[index];
+			out[i] += amplitude * (a + t * (table[index + 1] - a));
+			phase += increment;
+		}
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse2")
+	void wavetableAccumulateSSE2(
+		float* out, const float* table, size_t tableBits,
+		uint32_t phase, uint32_t increment, float amplitude, size_t n)
+	{
+		const uint32_t shift = 32 - static_cast<uint32_t>(tableBits);
+		const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+		const __m128i fractionMask = _mm_set1_epi32(static_cast<int>((uint32_t(1) << shift) - 1));
+		const __m128 fractionScale = _mm_set1_ps(1.f / static_cast<float>(uint32_t(1) << shift));
+		const __m128 amp = _mm_set1_ps(amplitude);
+		const __m128i step = _mm_set1_epi32(static_cast<int>(increment * 4));
+		__m128i ph = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(phase)),
+			_mm_setr_epi32(0, static_cast<int>(increment), static_cast<int>(increment * 2), static_cast<int>(increment * 3)));
+
+		size_t i = 0;
+		alignas(16) uint32_t index[4];
+		for (; i + 4 <= n; i += 4) {
+			_mm_store_si128(reinterpret_cast<__m128i*>(index), _mm_srl_epi32(ph, shiftCount));
+			__m128 a = _mm_setr_ps(table[index[0]], table[index[1]], table[index[2]], table[index[3]]);
+			__m128 b = _mm_setr_ps(table[index[0] + 1], table[index[1] + 1], table[index[2] + 1], table[index[3] + 1]);
+			__m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(ph, fractionMask)), fractionScale);
+			__m128 r = _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(amp, r)));
+			ph = _mm_add_epi32(ph, step);
+		}
+		wavetableAccumulateScalar(out + i, table, tableBits, phase + static_cast<uint32_t>(i) * increment, increment, amplitude, n - i);
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void wavetableAccumulateAVX2(
+		float* out, const float* table, size_t tableBits,
+		uint32_t phase, uint32_t increment, float amplitude, size_t n)
+	{
+		const uint32_t shift = 32 - static_cast<uint32_t>(tableBits);
+		const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+		const __m256i fractionMask = _mm256_set1_epi32(static_cast<int>((uint32_t(1) << shift) - 1));
+		const __m256 fractionScale = _mm256_set1_ps(1.f / static_cast<float>(uint32_t(1) << shift));
+		const __m256 amp = _mm256_set1_ps(amplitude);
+		const __m256i step = _mm256_set1_epi32(static_cast<int>(increment * 8));
+		__m256i ph = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(phase)),
+			_mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(increment))));
+
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			__m256i index = _mm256_srl_epi32(ph, shiftCount);
+			__m256 a = _mm256_i32gather_ps(table, index, 4);
+			__m256 b = _mm256_i32gather_ps(table + 1, index, 4);
+			__m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(ph, fractionMask)), fractionScale);
+			__m256 r = _mm256_fmadd_ps(t, _mm256_sub_ps(b, a), a);
+			_mm256_storeu_ps(out + i, _mm256_fmadd_ps(amp, r, _mm256_loadu_ps(out + i)));
+			ph = _mm256_add_epi32(ph, step);
+		}
+		wavetableAccumulateScalar(out + i, table, tableBits, phase + static_cast<uint32_t>(i) * increment, increment, amplitude, n - i);
+	}
+
+	SIMD_TARGET("avx512f")
+	void wavetableAccumulateAVX512(
+		float* out, const float* table, size_t tableBits,
+		uint32_t phase, uint32_t increment, float amplitude, size_t n)
+	{
+		const uint32_t shift = 32 - static_cast<uint32_t>(tableBits);
+		const __m128i shiftCount = _mm_cvtsi32_si128(static_cast<int>(shift));
+		const __m512i fractionMask = _mm512_set1_epi32(static_cast<int>((uint32_t(1) << shift) - 1));
+		const __m512 fractionScale = _mm512_set1_ps(1.f / static_cast<float>(uint32_t(1) << shift));
+		const __m512 amp = _mm512_set1_ps(amplitude);
+		const __m512i step = _mm512_set1_epi32(static_cast<int>(increment * 16));
+		__m512i ph = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(phase)), _mm512_mullo_epi32(
+			_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(static_cast<int>(increment))));
+
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			__m512i index = _mm512_srl_epi32(ph, shiftCount);
+			__m512 a = _mm512_i32gather_ps(index, table, 4);
+			__m512 b = _mm512_i32gather_ps(index, table + 1, 4);
+			__m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(ph, fractionMask)), fractionScale);
+			__m512 r = _mm512_fmadd_ps(t, _mm512_sub_ps(b, a), a);
+			_mm512_storeu_ps(out + i, _mm512_fmadd_ps(amp, r, _mm512_loadu_ps(out + i)));
+			ph = _mm512_add_epi32(ph, step);
+		}
+		wavetableAccumulateScalar(out + i, table, tableBits, phase + static_cast<uint32_t>(i) * increment, increment, amplitude, n - i);
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void wavetableAccumulateNEON(
+		float* out, const float* table, size_t tableBits,
+		uint32_t phase, uint32_t increment, float amplitude, size_t n)
+	{
+		const uint32_t shift = 32 - static_cast<uint32_t>(tableBits);
+		const int32x4_t shiftCount = vdupq_n_s32(-static_cast<int32_t>(shift));
+		const uint32x4_t fractionMask = vdupq_n_u32((uint32_t(1) << shift) - 1);
+		const float fractionScale = 1.f / static_cast<float>(uint32_t(1) << shift);
+		const uint32_t offsets[4] = { 0, increment, increment * 2, increment * 3 };
+		uint32x4_t ph = vaddq_u32(vdupq_n_u32(phase), vld1q_u32(offsets));
+		const uint32x4_t step = vdupq_n_u32(increment * 4);
+
+		size_t i = 0;
+		uint32_t index[4];
+		for (; i + 4 <= n; i += 4) {
+			vst1q_u32(index, vshlq_u32(ph, shiftCount));
+			const float aLanes[4] = { table[index[0]], table[index[1]], table[index[2]], table[index[3]] };
+			const float bLanes[4] = { table[index[0] + 1], table[index[1] + 1], table[index[2] + 1], table[index[3] + 1] };
+			float32x4_t a = vld1q_f32(aLanes);
+			float32x4_t b = vld1q_f32(bLanes);
+			float32x4_t t = vmulq_n_f32(vcvtq_f32_u32(vandq_u32(ph, fractionMask)), fractionScale);
+			float32x4_t r = vmlaq_f32(a, t, vsubq_f32(b, a));
+			vst1q_f32(out + i, vmlaq_n_f32(vld1q_f32(out + i), r, amplitude));
+			ph = vaddq_u32(ph, step);
+		}
+		wavetableAccumulateScalar(out + i, table, tableBits, phase + static_cast<uint32_t>(i) * increment, increment, amplitude, n - i);
+	}
+#endif
+
+	typedef void (*WavetableAccumulateFn)(float*, const float*, size_t, uint32_t, uint32_t, float, size_t);
+
+	WavetableAccumulateFn selectWavetableAccumulate()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return wavetableAccumulateAVX512;
+		case InstructionSet::AVX2: return wavetableAccumulateAVX2;
+		case InstructionSet::SSE2: return wavetableAccumulateSSE2;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return wavetableAccumulateNEON;
+#endif
+		default: return wavetableAccumulateScalar;
+		}
+	}
+
+	const WavetableAccumulateFn wavetableAccumulateImpl = selectWavetableAccumulate();
+
+	/** Noise */
+
+	// Scale of the upper 24 bits of a generator state, mapping to [0, 2)
+	constexpr float noiseScale = 2.f / 16777216.f;
+
+	inline uint32_t xorshift(uint32_t x)
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		return x;
+	}
+
+	void noiseAccumulateScalar(float* out, uint32_t* state, float amplitude, size_t n)
+	{
+		uint32_t x = state[0];
+		for (size_t i = 0; i < n; i++) {
+			x = xorshift(x);
+			out[i] += amplitude * (static_cast<float>(x >> 8) * noiseScale - 1.f);
+		}
+		state[0] = x;
+	}
+
+#if defined(SIMD_X86)
+	SIMD_TARGET("sse2")
+	void noiseAccumulateSSE2(float* out, uint32_t* state, float amplitude, size_t n)
+	{
+		const __m128 scale = _mm_set1_ps(amplitude * noiseScale);
+		const __m128 amp = _mm_set1_ps(amplitude);
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state));
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+			x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+			x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+			__m128 r = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(x, 8)), scale), amp);
+			_mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i), r));
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(state), x);
+		noiseAccumulateScalar(out + i, state, amplitude, n - i);
+	}
+
+	SIMD_TARGET("avx2,fma")
+	void noiseAccumulateAVX2(float* out, uint32_t* state, float amplitude, size_t n)
+	{
+		const __m256 scale = _mm256_set1_ps(amplitude * noiseScale);
+		const __m256 amp = _mm256_set1_ps(amplitude);
+		__m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(state));
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+			x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+			x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+			__m256 r = _mm256_fmsub_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(x, 8)), scale, amp);
+			_mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(out + i), r));
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(state), x);
+		noiseAccumulateScalar(out + i, state, amplitude, n - i);
+	}
+
+	SIMD_TARGET("avx512f")
+	void noiseAccumulateAVX512(float* out, uint32_t* state, float amplitude, size_t n)
+	{
+		const __m512 scale = _mm512_set1_ps(amplitude * noiseScale);
+		const __m512 amp = _mm512_set1_ps(amplitude);
+		__m512i x = _mm512_loadu_si512(state);
+		size_t i = 0;
+		for (; i + 16 <= n; i += 16) {
+			x = _mm512_xor_si512(x, _mm512_slli_epi32(x, 13));
+			x = _mm512_xor_si512(x, _mm512_srli_epi32(x, 17));
+			x = _mm512_xor_si512(x, _mm512_slli_epi32(x, 5));
+			__m512 r = _mm512_fmsub_ps(_mm512_cvtepi32_ps(_mm512_srli_epi32(x, 8)), scale, amp);
+			_mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(out + i), r));
+		}
+		_mm512_storeu_si512(state, x);
+		noiseAccumulateScalar(out + i, state, amplitude, n - i);
+	}
+#endif
+
+#if defined(SIMD_NEON)
+	void noiseAccumulateNEON(float* out, uint32_t* state, float amplitude, size_t n)
+	{
+		const float scale = amplitude * noiseScale;
+		const float32x4_t amp = vdupq_n_f32(amplitude);
+		uint32x4_t x = vld1q_u32(state);
+		size_t i = 0;
+		for (; i + 4 <= n; i += 4) {
+			x = veorq_u32(x, vshlq_n_u32(x, 13));
+			x = veorq_u32(x, vshrq_n_u32(x, 17));
+			x = veorq_u32(x, vshlq_n_u32(x, 5));
+			float32x4_t r = vsubq_f32(vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(x, 8)), scale), amp);
+			vst1q_f32(out + i, vaddq_f32(vld1q_f32(out + i), r));
+		}
+		vst1q_u32(state, x);
+		noiseAccumulateScalar(out + i, state, amplitude, n - i);
+	}
+#endif
+
+	typedef void (*NoiseAccumulateFn)(float*, uint32_t*, float, size_t);
+
+	NoiseAccumulateFn selectNoiseAccumulate()
+	{
+		switch (activeInstructionSet) {
+#if defined(SIMD_X86)
+		case InstructionSet::AVX512: return noiseAccumulateAVX512;
+		case InstructionSet::AVX2: return noiseAccumulateAVX2;
+		case InstructionSet::SSE2: return noiseAccumulateSSE2;
+#endif
+#if defined(SIMD_NEON)
+		case InstructionSet::NEON: return noiseAccumulateNEON;
+#endif
+		default: return noiseAccumulateScalar;
+		}
+	}
+
+	const NoiseAccumulateFn noiseAccumulateImpl = selectNoiseAccumulate();
+}
+
+const char* simd::instructionSet()
+{
+	switch (activeInstructionSet) {
+	case InstructionSet::SSE: return "SSE";
+	case InstructionSet::SSE2: return "SSE2";
+	case InstructionSet::AVX2: return "AVX2";
+	case InstructionSet::AVX512: return "AVX-512";
+	case InstructionSet::NEON: return "NEON";
+	default: return "Scalar";
+	}
+}
+
+void simd::complexMultiplyAdd(
+	float* accRe, float* accIm,
+	const float* aRe, const float* aIm,
+	const float* bRe, const float* bIm,
+	size_t n)
+{
+	complexMultiplyAddImpl(accRe, accIm, aRe, aIm, bRe, bIm, n);
+}
+
+void simd::cubicInterpolate(float* out, const float* x, const int32_t* index, const float* t, size_t n)
+{
+	cubicInterpolateImpl(out, x, index, t, n);
+}
+
+void simd::polyphaseInterpolate(
+	float* out, const float* x, const int32_t* index, const float* t, size_t n,
+	const float* coefficients, const float* deltas, size_t taps, size_t phases)
+{
+	polyphaseInterpolateImpl(out, x, index, t, n, coefficients, deltas, taps, phases);
+}
+
+void simd::gainAccumulate(float* acc, const float* x, float gain, float gainIncrement, size_t n)
+{
+	gainAccumulateImpl(acc, x, gain, gainIncrement, n);
+}
+
+void simd::exponentialRamp(float* out, const float* in, float target, float start, float decay, size_t n)
+{
+	exponentialRampImpl(out, in, target, start, decay, n);
+}
+
+void simd::wavetableAccumulate(
+	float* out, const float* table, size_t tableBits,
+	uint32_t phase, uint32_t increment, float amplitude, size_t n)
+{
+	wavetableAccumulateImpl(out, table, tableBits, phase, increment, amplitude, n);
+}
+
+void simd::noiseAccumulate(float* out, uint32_t* state, float amplitude, size_t n)
+{
+	noiseAccumulateImpl(out, state, amplitude, n);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Vectorized DSP kernels. Each kernel is implemented for SSE, AVX2 (with FMA), AVX-512 and NEON
+// where available, and the fastest implementation supported by the running CPU is selected once
+// at startup. Pointers do not need to be aligned.
+namespace simd
+{
+	// Returns the name of the instruction set selected at runtime
+	const char* instructionSet();
+
+	// Split-complex multiply-accumulate over `n` bins: acc += a * b
+	void complexMultiplyAdd(
+		float* accRe, float* accIm,
+		const float* aRe, const float* aIm,
+		const float* bRe, const float* bIm,
+		size_t n);
+
+	// Four-point cubic interpolation at `n` fractional positions. out[j] interpolates between
+	// x[index[j] + 1] and x[index[j] + 2] at fraction t[j] in [0, 1), reading x[index[j]] to x[index[j] + 3].
+	void cubicInterpolate(float* out, const float* x, const int32_t* index, const float* t, size_t n);
+
+	// Polyphase FIR interpolation at `n` fractional positions. out[j] is the dot product of x[index[j]]
+	// to x[index[j] + taps - 1] with the coefficients of phase t[j] * phases, interpolated linearly between
+	// tabulated phases. `coefficients` and `deltas` hold `taps` values per phase. `taps` must be a multiple of 4.
+	void polyphaseInterpolate(
+		float* out, const float* x, const int32_t* index, const float* t, size_t n,
+		const float* coefficients, const float* deltas, size_t taps, size_t phases);
+
+	// Gain-and-accumulate with a linear gain ramp: acc[i] += x[i] * (gain + i * gainIncrement)
+	void gainAccumulate(float* acc, const float* x, float gain, float gainIncrement, size_t n);
+
+	// Exponential approach of `start` towards `target`: ramp[i] = target + (start - target) * decay^(i + 1).
+	// Writes in[i] * ramp[i] to out[i], or ramp[i] if `in` is null. `in` may equal `out`.
+	void exponentialRamp(float* out, const float* in, float target, float start, float decay, size_t n);
+
+	// Linearly interpolated wavetable oscillator, accumulated into `out`. `table` holds 2^tableBits samples
+	// followed by a copy of the first. The 32-bit `phase` wraps once per cycle and advances by `increment`
+	// per sample: out[i] += amplitude * table(phase + i * increment).
+	void wavetableAccumulate(
+		float* out, const float* table, size_t tableBits,
+		uint32_t phase, uint32_t increment, float amplitude, size_t n);
+
+	// Number of independent generator states used by noiseAccumulate()
+	constexpr size_t noiseLanes = 16;
+
+	// Uniform white noise in [-amplitude, amplitude), accumulated into `out`. `state` holds noiseLanes
+	// non-zero xorshift generator states, which are advanced.
+	void noiseAccumulate(float* out, uint32_t* state, float amplitude, size_t n);
+}
@@ -0,0 +1,91 @@
+#include "AWavetable.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Amplitude of harmonic `k` of a waveform's Fourier sine series, or 0 if not present
+	double harmonicAmplitude(AWaveform waveform, size_t k)
+	{
+		constexpr double pi = 3.14159265358979323846;
+		const double n = static_cast<double>(k);
+		switch (waveform) {
+		case AWaveform::Sine: return k == 1 ? 1.0 : 0.0;
+		case AWaveform::Saw: return (k % 2 ? 2.0 : -2.0) / (pi * n);
+		case AWaveform::Square: return k % 2 ? 4.0 / (pi * n) : 0.0;
+		case AWaveform::Triangle: return k % 2 ? ((k / 2) % 2 ? -8.0 : 8.0) / (pi * pi * n * n) : 0.0;
+		default: return 0.0;
+		}
+	}
+}
+
+AWavetable::AWavetable(AWaveform waveform) :
+	levels(levelCount * (tableSize + 1))
+{
+	constexpr double pi = 3.14159265358979323846;
+
+	// sin(2 pi k i / N) is sine[(k * i) % N], so no trigonometry is needed per harmonic
+	std::vector<double> sine(tableSize);
+	for (size_t i = 0; i < tableSize; i++) sine[i] = std::sin(2.0 * pi * static_cast<double>(i) / static_cast<double>(tableSize));
+
+	// each level adds the harmonics above the previous level's limit
+	std::vector<double> sum(tableSize, 0.0);
+	size_t harmonic = 1;
+	double peak = 0.0;
+	for (size_t l = 0; l < levelCount; l++) {
+		const size_t maxHarmonic = size_t(1) << l;
+		for (; harmonic <= maxHarmonic; harmonic++) {
+			double amplitude = harmonicAmplitude(waveform, harmonic);
+			if (amplitude == 0.0) continue;
+			for (size_t i = 0; i < tableSize; i++) sum[i] += amplitude * sine[(harmonic * i) % tableSize];
+		}
+
+		float* table = levels.data() + l * (tableSize + 1);
+		for (size_t i = 0; i < tableSize; i++) {
+			table[i] = static_cast<float>(sum[i]);
+			peak = std::max(peak, std::abs(sum[i]));
+		}
+		table[tableSize] = table[0];
+	}
+
+	// normalize all levels by the same factor, so the level does not change with the band limit
+	if (peak > 0.0) {
+		const float scale = static_cast<float>(1.0 / peak);
+		for (auto& sample : levels) sample *= scale;
+	}
+}
+
+const AWavetable* AWavetable::get(AWaveform waveform)
+{
+	switch (waveform) {
+	case AWaveform::Sine: {
+		static const AWavetable table(AWaveform::Sine);
+		return &table;
+	}
+	case AWaveform::Saw: {
+		static const AWavetable table(AWaveform::Saw);
+		return &table;
+	}
+	case AWaveform::Square: {
+		static const AWavetable table(AWaveform::Square);
+		return &table;
+	}
+	case AWaveform::Triangle: {
+		static const AWavetable table(AWaveform::Triangle);
+		return &table;
+	}
+	default:
+		return nullptr;
+	}
+}
+
+const float* AWavetable::level(float normalizedFrequency) const
+{
+	// the highest level whose harmonics all stay below Nyquist
+	size_t l = 0;
+	if (normalizedFrequency > 0.f) {
+		float maxHarmonics = 0.5f / normalizedFrequency;
+		while (l + 1 < levelCount && static_cast<float>(size_t(1) << (l + 1)) <= maxHarmonics) l++;
+	}
+	return levels.data() + l * (tableSize + 1);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Signal shapes produced by AOscillatorBank
+enum class AWaveform
+{
+	Sine,
+	Saw,
+	Square,
+	Triangle,
+
+	// Uniform white noise
+	WhiteNoise,
+
+	// White noise filtered to a -3 dB per octave slope
+	PinkNoise
+};
+
+// AWavetable holds one cycle of a periodic waveform at several band limits ("mip levels"), so that
+// oscillators can read a table without harmonics above Nyquist at any frequency. Each level is
+// built by additive synthesis on first use, and holds twice as many harmonics as the level below.
+class AWavetable
+{
+public:
+
+	// Table length is 2^tableBits samples per level, followed by a copy of the first sample
+	static constexpr size_t tableBits = 11;
+	static constexpr size_t tableSize = size_t(1) << tableBits;
+
+	// Level `l` holds up to 2^l harmonics
+	static constexpr size_t levelCount = 10;
+
+	// Return the shared table of a periodic waveform, building it on first use.
+	// Returns nullptr for noise waveforms.
+	static const AWavetable* get(AWaveform waveform);
+
+	// Return the level without harmonics above Nyquist for a frequency relative to the sample rate
+	const float* level(float normalizedFrequency) const;
+
+private:
+
+	AWavetable(AWaveform waveform);
+
+	// `levelCount` tables of tableSize + 1 samples
+	std::vector<float> levels;
+};
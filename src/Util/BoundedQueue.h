@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+// Size of a cache line, used to keep producer and consumer state from sharing one
+constexpr size_t cacheLineSize = 64;
+
+// SPSCQueue is a fixed-capacity, single-producer single-consumer lock-free ring buffer.
+// Neither push() nor pop() allocates or blocks, so both are safe on the audio thread.
+// A full queue rejects the pushed value, which the producer must handle.
+template<typename T>
+class SPSCQueue
+{
+public:
+
+	// Allocate storage for at least `capacity` values, rounded up to a power of two
+	explicit SPSCQueue(size_t capacity) :
+		capacity(roundUpPow2(capacity)),
+		values(std::make_unique<T[]>(this->capacity)),
+		head(0),
+		cachedTail(0),
+		tail(0),
+		cachedHead(0)
+	{
+	}
+
+	// Producer only. Returns false, leaving the queue unchanged, if the queue is full.
+	[[nodiscard]] bool push(const T& val)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - cachedHead == capacity) {
+			cachedHead = head.load(std::memory_order_acquire);
+			if (t - cachedHead == capacity) return false;
+		}
+
+		values[t & (capacity - 1)] = val;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Consumer only. Returns false if the queue is empty.
+	bool pop(T& val)
+	{
+		size_t h = head.load(std::memory_order_relaxed);
+		if (h == cachedTail) {
+			cachedTail = tail.load(std::memory_order_acquire);
+			if (h == cachedTail) return false;
+		}
+
+		val = values[h & (capacity - 1)];
+		head.store(h + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Producer only. Returns true if the next push() would fail.
+	bool full()
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		if (t - cachedHead < capacity) return false;
+		cachedHead = head.load(std::memory_order_acquire);
+		return t - cachedHead == capacity;
+	}
+
+private:
+
+	static size_t roundUpPow2(size_t n)
+	{
+		size_t pow2 = 1;
+		while (pow2 < n) pow2 <<= 1;
+		return pow2;
+	}
+
+	const size_t capacity;
+
+	const std::unique_ptr<T[]> values;
+
+	// Consumer state, with the consumer's last view of the producer position
+	alignas(cacheLineSize) std::atomic<size_t> head;
+	size_t cachedTail;
+
+	// Producer state, with the producer's last view of the consumer position
+	alignas(cacheLineSize) std::atomic<size_t> tail;
+	size_t cachedHead;
+};
+
+// MPSCQueue is a fixed-capacity, multiple-producer single-consumer lock-free queue. Producers
+// claim slots through a shared counter and publish them through per-slot sequence numbers.
+// Neither push() nor pop() allocates. A full queue rejects the pushed value.
+template<typename T>
+class MPSCQueue
+{
+public:
+
+	// Allocate storage for at least `capacity` values, rounded up to a power of two
+	explicit MPSCQueue(size_t capacity) :
+		capacity(roundUpPow2(capacity)),
+		cells(std::make_unique<Cell[]>(this->capacity)),
+		head(0),
+		tail(0)
+	{
+		for (size_t i = 0; i < this->capacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+
+	// Any thread. Returns false, leaving the queue unchanged, if the queue is full.
+	[[nodiscard]] bool push(const T& val)
+	{
+		size_t t = tail.load(std::memory_order_relaxed);
+		while (true) {
+			Cell& cell = cells[t & (capacity - 1)];
+			size_t sequence = cell.sequence.load(std::memory_order_acquire);
+			auto diff = static_cast<ptrdiff_t>(sequence - t);
+			if (diff == 0) {
+				// slot is free, try to claim it
+				if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)) {
+					cell.value = val;
+					cell.sequence.store(t + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0) {
+				// slot still holds a value from one lap ago
+				return false;
+			}
+			else {
+				t = tail.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// Consumer only. Returns false if the queue is empty or the next value is not yet published.
+	bool pop(T& val)
+	{
+		Cell& cell = cells[head & (capacity - 1)];
+		if (cell.sequence.load(std::memory_order_acquire) != head + 1) return false;
+
+		val = cell.value;
+		cell.sequence.store(head + capacity, std::memory_order_release);
+		head++;
+		return true;
+	}
+
+private:
+
+	static size_t roundUpPow2(size_t n)
+	{
+		size_t pow2 = 1;
+		while (pow2 < n) pow2 <<= 1;
+		return pow2;
+	}
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	const size_t capacity;
+
+	const std::unique_ptr<Cell[]> cells;
+
+	// Consumer position, only accessed by the consumer
+	alignas(cacheLineSize) size_t head;
+
+	// Next slot to be claimed by a producer
+	alignas(cacheLineSize) std::atomic<size_t> tail;
+};
@@ -5,6 +5,7 @@
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 
 class ThreadPool
 {
@@ -30,6 +31,7 @@ public:
 						{
 							std::unique_lock<std::mutex> lock(mutex);
 							workersBusy--;
+							if (!workersBusy && tasks.empty()) condition.notify_all();
 							condition.wait(lock, [this] { return bQuit || !tasks.empty(); });
 							if (bQuit && tasks.empty()) return;
 							workersBusy++;
@@ -1,7 +1,24 @@
 #include "Engine/Engine.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Sample rate of offline renders
+constexpr float renderSampleRate = 48000.f;
 
 int main(int argc, char* args[])
 {
+	// render without a window or audio device: --render <file.wav> <seconds> [speakers]
+	if (argc >= 4 && std::strcmp(args[1], "--render") == 0) {
+		float seconds = static_cast<float>(std::atof(args[3]));
+		size_t speakers = argc >= 5 ? static_cast<size_t>(std::atoi(args[4])) : 1;
+
+		Engine engine;
+		bool bSuccess = engine.initOffline(renderSampleRate) && engine.renderOffline(args[2], seconds, speakers);
+		engine.deinit();
+		return bSuccess ? 0 : 1;
+	}
+
 	Engine engine;
 	engine.init();
 	engine.run();